@@ -0,0 +1,441 @@
+/**************************************************************************************************
+* benchmark.c: Jmfr tidstgng samt konvergens fr olika trningsmetoder fr regressionsmodeller
+*              baserade p linjr regression. Syntetisk trningsdata genereras enligt formeln
+*              y = -5x + 0.5 med ett litet brus, varefter modeller trnas sekventiellt, med
+*              pipelinad randomisering, p vxande slumpmssiga delmngder samt asynkront
+*              (Hogwild) med ett varierande antal trdar.
+*              Fr varje metod skrivs tidstgng, medelkvadratfel samt trnade parametrar ut.
+*              Drefter jmfrs antalet epoker till konvergens med och utan standardisering fr
+*              insignaler med stort belopp, dr ostandardiserad trning krver en mycket lg
+*              lrhastighet fr att inte divergera. Sedan mts genomstrmningen vid strmmande
+*              batchprediktion frn fil till fil i text- och binrformat, varefter det
+*              kontrolleras att trning som terupptas frn en kontrollpunkt ger exakt samma
+*              parametrar som oavbruten trning. Drefter skrivs hrdvarurknare per fas ut fr inlsning, trning och prediktion via fil.
+*              Slutligen skrivs minnesstatistik per delsystem ut, frutsatt att programmet har
+*              kompilerats med -DLIN_REG_MEM_STATS.
+*
+*              Kompilera koden och skapa en krbar fil dpt benchmark.exe med fljande kommando:
+*              $ gcc benchmark.c lin_reg.c double_vector.c uint_vector.c train_buffer.c block_queue.c decompressor.c perf_counters.c checkpoint.c mem_stats.c score_pipeline.c -o benchmark.exe -Wall -O2 -pthread -lm
+*
+*              Kr sedan programmet med fljande kommando, dr antalet trningsuppsttningar
+*              samt antalet epoker kan anges (default 1000000 respektive 10):
+*              $ benchmark.exe [num_sets] [num_epochs]
+**************************************************************************************************/
+#include "lin_reg.h"
+
+/* Makrodefinitioner: */
+#define BENCHMARK_LEARNING_RATE 0.01 /* Lrhastighet som anvnds vid jmfrelse av metoder. */
+#define BENCHMARK_MAX_EPOCHS 1000     /* Maximalt antal epoker vid mtning av konvergens. */
+#define BENCHMARK_OFFSET 1000.0       /* Insignalernas frskjutning vid mtning av konvergens. */
+
+// Statiska funktioner:
+static void benchmark_generate(double* train_in,
+                               double* train_out,
+                               const size_t num_sets);
+static void benchmark_convergence(const char* name,
+                                  const double* train_in,
+                                  const double* train_out,
+                                  const size_t num_sets,
+                                  const double learning_rate,
+                                  const bool standardize,
+                                  const double tolerance);
+static void benchmark_score(const char* name,
+                            const struct lin_reg* model,
+                            const double* train_in,
+                            const size_t num_sets,
+                            const enum score_pipeline_format format);
+static void benchmark_resume(const double* train_in,
+                             const double* train_out,
+                             const size_t num_sets,
+                             const size_t num_epochs);
+static void benchmark_profile(const double* train_in,
+                              const double* train_out,
+                              const size_t num_sets,
+                              const size_t num_epochs,
+                              const size_t num_threads);
+static void benchmark_print(const char* name,
+                            const size_t num_threads,
+                            const double seconds,
+                            const struct lin_reg* model);
+
+/**************************************************************************************************
+* main: Genererar trningsdata och trnar en ny regressionsmodell per trningsmetod, dr samma
+*       trningsdata, startvrde fr slumpgeneratorn, antal epoker och lrhastighet anvnds.
+**************************************************************************************************/
+int main(int argc, char** argv)
+{
+   const size_t num_sets = argc > 1 ? (size_t)strtoull(argv[1], 0, 10) : 1000000;
+   const size_t num_epochs = argc > 2 ? (size_t)strtoull(argv[2], 0, 10) : 10;
+   const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   double* train_in = (double*)malloc(sizeof(double) * num_sets);
+   double* train_out = (double*)malloc(sizeof(double) * num_sets);
+
+   if (!num_sets || !train_in || !train_out)
+   {
+      fprintf(stderr, "Could not allocate memory for %zu training sets!\n\n", num_sets);
+      free(train_in);
+      free(train_out);
+      return 1;
+   }
+
+   benchmark_generate(train_in, train_out, num_sets);
+   printf("Training sets: %zu, epochs: %zu, learning rate: %g\n",
+          num_sets, num_epochs, BENCHMARK_LEARNING_RATE);
+   printf("--------------------------------------------------------------------------\n");
+   printf("%-20s %8s %12s %14s %12s %12s\n", "Method", "Threads", "Time [s]", "MSE", "Weight", "Bias");
+
+   for (size_t method = 0; method < 2; ++method)
+   {
+      struct lin_reg l1;
+      struct timespec start;
+      lin_reg_new(&l1);
+      lin_reg_set_training_data(&l1, train_in, train_out, num_sets);
+      lin_reg_set_pipelined_shuffle(&l1, method == 1);
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      lin_reg_train(&l1, num_epochs, BENCHMARK_LEARNING_RATE);
+      benchmark_print(method ? "pipelined shuffle" : "sequential", 1, perf_counters_elapsed(&start), &l1);
+      lin_reg_delete(&l1);
+   }
+
+   {
+      struct lin_reg l1;
+      struct timespec start;
+      char name[32] = { '\0' };
+      lin_reg_new(&l1);
+      lin_reg_set_training_data(&l1, train_in, train_out, num_sets);
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      const size_t sample_size = lin_reg_train_progressive(&l1, BENCHMARK_LEARNING_RATE, 1000,
+                                                           num_epochs, 0.001);
+      snprintf(name, sizeof(name), "progressive (%zu)", sample_size);
+      benchmark_print(name, 1, perf_counters_elapsed(&start), &l1);
+      lin_reg_delete(&l1);
+   }
+
+   for (size_t num_threads = 1; num_threads <= (size_t)(num_cpus > 0 ? num_cpus : 1); num_threads *= 2)
+   {
+      struct lin_reg l1;
+      struct timespec start;
+      lin_reg_new(&l1);
+      lin_reg_set_training_data(&l1, train_in, train_out, num_sets);
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      lin_reg_train_hogwild(&l1, num_epochs, BENCHMARK_LEARNING_RATE, num_threads);
+      benchmark_print("hogwild", num_threads, perf_counters_elapsed(&start), &l1);
+      lin_reg_delete(&l1);
+   }
+
+   printf("--------------------------------------------------------------------------\n\n");
+
+   for (size_t i = 0; i < num_sets; ++i)
+   {
+      train_in[i] += BENCHMARK_OFFSET;
+      train_out[i] -= 5 * BENCHMARK_OFFSET;
+   }
+
+   printf("Convergence with inputs in [%g, %g], tolerance: MSE within 5 %% of noise level\n",
+          BENCHMARK_OFFSET - 1, BENCHMARK_OFFSET + 1);
+   printf("--------------------------------------------------------------------------\n");
+   printf("%-20s %12s %8s %12s %14s %12s\n", "Method", "Rate", "Epochs", "Time [s]", "MSE", "Weight");
+   benchmark_convergence("raw", train_in, train_out, num_sets,
+                         1.0 / (BENCHMARK_OFFSET * BENCHMARK_OFFSET), false, 1.05 * 0.01 / 3);
+   benchmark_convergence("standardized", train_in, train_out, num_sets,
+                         BENCHMARK_LEARNING_RATE, true, 1.05 * 0.01 / 3);
+   printf("--------------------------------------------------------------------------\n\n");
+
+   {
+      struct lin_reg l1;
+      lin_reg_new(&l1);
+      lin_reg_set_training_data(&l1, train_in, train_out, num_sets);
+      lin_reg_set_standardize(&l1, true);
+      lin_reg_train(&l1, 1, BENCHMARK_LEARNING_RATE);
+      printf("Streaming file-to-file scoring\n");
+      printf("--------------------------------------------------------------------------\n");
+      printf("%-20s %12s %12s %14s\n", "Format", "Rows", "Time [s]", "Rows/s");
+      benchmark_score("text", &l1, train_in, num_sets, SCORE_PIPELINE_FORMAT_TEXT);
+      benchmark_score("binary", &l1, train_in, num_sets, SCORE_PIPELINE_FORMAT_BINARY);
+      printf("--------------------------------------------------------------------------\n\n");
+      lin_reg_delete(&l1);
+   }
+
+   benchmark_resume(train_in, train_out, num_sets, num_epochs);
+   benchmark_profile(train_in, train_out, num_sets, num_epochs, (size_t)(num_cpus > 0 ? num_cpus : 1));
+   printf("Memory usage per subsystem\n");
+   mem_stats_print(stdout);
+   free(train_in);
+   free(train_out);
+   return 0;
+}
+
+/**************************************************************************************************
+* benchmark_generate: Genererar trningsdata enligt formeln y = -5x + 0.5, dr insignalerna
+*                     ligger inom intervallet [-1, 1] och utsignalerna har ett brus p upp till
+*                     +/- 0.1. Samma trningsdata genereras vid varje krning.
+*
+*                     - train_in : Pekare till array dr insignaler lagras.
+*                     - train_out: Pekare till array dr utsignaler lagras.
+*                     - num_sets : Antalet trningsuppsttningar som skall genereras.
+**************************************************************************************************/
+static void benchmark_generate(double* train_in,
+                               double* train_out,
+                               const size_t num_sets)
+{
+   srand(1);
+
+   for (size_t i = 0; i < num_sets; ++i)
+   {
+      const double x = 2.0 * rand() / RAND_MAX - 1.0;
+      const double noise = 0.2 * rand() / RAND_MAX - 0.1;
+      train_in[i] = x;
+      train_out[i] = -5 * x + 0.5 + noise;
+   }
+
+   return;
+}
+
+/**************************************************************************************************
+* benchmark_convergence: Trnar en ny regressionsmodell en epok t gngen tills medelkvadratfelet
+*                        understiger angiven tolerans eller maximalt antal epoker har genomfrts,
+*                        varefter antalet epoker, tidstgng och resultat skrivs ut. Tidstgngen
+*                        inkluderar berkning av skalning, som sker vid frsta anropet av
+*                        lin_reg_train och sedan teranvnds eftersom trningsdatan inte ndras.
+*
+*                        - name         : Metodens namn.
+*                        - train_in     : Pekare till array innehllande insignaler.
+*                        - train_out    : Pekare till array innehllande utsignaler.
+*                        - num_sets     : Antalet trningsuppsttningar.
+*                        - learning_rate: Lrhastighet vid trning.
+*                        - standardize  : Indikerar ifall standardisering skall anvndas.
+*                        - tolerance    : Medelkvadratfel som rknas som konvergens.
+**************************************************************************************************/
+static void benchmark_convergence(const char* name,
+                                  const double* train_in,
+                                  const double* train_out,
+                                  const size_t num_sets,
+                                  const double learning_rate,
+                                  const bool standardize,
+                                  const double tolerance)
+{
+   struct lin_reg l1;
+   struct timespec start;
+   size_t epochs = 0;
+   double mse = 0;
+   lin_reg_new(&l1);
+   lin_reg_set_training_data(&l1, train_in, train_out, num_sets);
+   lin_reg_set_standardize(&l1, standardize);
+   clock_gettime(CLOCK_MONOTONIC, &start);
+
+   while (epochs < BENCHMARK_MAX_EPOCHS)
+   {
+      lin_reg_train(&l1, 1, learning_rate);
+      mse = lin_reg_mean_squared_error(&l1);
+      epochs++;
+      if (mse <= tolerance) break;
+   }
+
+   const double seconds = perf_counters_elapsed(&start);
+
+   if (mse <= tolerance)
+   {
+      printf("%-20s %12g %8zu %12.4f %14.6g %12.6f\n", name, learning_rate, epochs, seconds, mse, l1.weight);
+   }
+   else
+   {
+      printf("%-20s %12g %8s %12.4f %14.6g %12.6f\n", name, learning_rate, "-", seconds, mse, l1.weight);
+   }
+
+   lin_reg_delete(&l1);
+   return;
+}
+
+/**************************************************************************************************
+* benchmark_score: Skriver angivna insignaler till en temporr infil i angivet format, predikterar
+*                  samtliga insignaler frn fil till fil via angiven regressionsmodell och skriver
+*                  ut antalet rader, tidstgng samt genomstrmning. Tidstgngen avser enbart
+*                  prediktionen. Temporra filer tas bort eftert.
+*
+*                  - name    : Formatets namn.
+*                  - model   : Pekare till den trnade regressionsmodellen.
+*                  - train_in: Pekare till array innehllande insignaler.
+*                  - num_sets: Antalet insignaler.
+*                  - format  : Filformat fr in- och utfilen.
+**************************************************************************************************/
+static void benchmark_score(const char* name,
+                            const struct lin_reg* model,
+                            const double* train_in,
+                            const size_t num_sets,
+                            const enum score_pipeline_format format)
+{
+   const char* input_path = "benchmark_score_in.tmp";
+   const char* output_path = "benchmark_score_out.tmp";
+   struct score_pipeline_stats stats;
+   FILE* fstream = fopen(input_path, "wb");
+   int error = !fstream;
+
+   for (size_t i = 0; i < num_sets && !error; ++i)
+   {
+      if (format == SCORE_PIPELINE_FORMAT_BINARY)
+      {
+         error = fwrite(&train_in[i], sizeof(double), 1, fstream) != 1;
+      }
+      else
+      {
+         error = fprintf(fstream, "%.17g\n", train_in[i]) < 0;
+      }
+   }
+
+   if (fstream) error |= fclose(fstream) != 0;
+   if (!error) error = lin_reg_score_file(model, input_path, output_path, format, &stats);
+
+   if (error)
+   {
+      printf("%-20s %12s %12s %14s\n", name, "-", "-", "-");
+   }
+   else
+   {
+      printf("%-20s %12zu %12.4f %14.0f\n", name, stats.rows, stats.seconds, stats.rows_per_second);
+   }
+
+   remove(input_path);
+   remove(output_path);
+   return;
+}
+
+/**************************************************************************************************
+* benchmark_resume: Trnar en regressionsmodell med standardisering utan avbrott, samt en andra
+*                   modell som avbryts efter halva antalet epoker med en kontrollpunkt. En tredje
+*                   modell terupptar sedan trningen frn kontrollpunkten till angivet antal
+*                   epoker, varefter det kontrolleras att parametrarna r bitidentiska med den
+*                   oavbrutna trningen. Kontrollpunktsfilen tas bort eftert.
+*
+*                   - train_in  : Pekare till array innehllande insignaler.
+*                   - train_out : Pekare till array innehllande utsignaler.
+*                   - num_sets  : Antalet trningsuppsttningar.
+*                   - num_epochs: Totalt antal epoker.
+**************************************************************************************************/
+static void benchmark_resume(const double* train_in,
+                             const double* train_out,
+                             const size_t num_sets,
+                             const size_t num_epochs)
+{
+   const char* filepath = "benchmark_checkpoint.tmp";
+   const size_t interrupted = num_epochs > 1 ? num_epochs / 2 : 1;
+   struct lin_reg models[3];
+   struct checkpoint checkpoint;
+   int error = checkpoint_new(&checkpoint, filepath, interrupted, 0);
+
+   for (size_t i = 0; i < 3; ++i)
+   {
+      lin_reg_new(&models[i]);
+      lin_reg_set_training_data(&models[i], train_in, train_out, num_sets);
+      lin_reg_set_standardize(&models[i], true);
+   }
+
+   lin_reg_train(&models[0], num_epochs, BENCHMARK_LEARNING_RATE);
+
+   if (!error)
+   {
+      lin_reg_set_checkpoint(&models[1], &checkpoint);
+      lin_reg_train(&models[1], interrupted, BENCHMARK_LEARNING_RATE);
+      error = checkpoint_wait(&checkpoint);
+      checkpoint_delete(&checkpoint);
+   }
+
+   if (!error) error = lin_reg_resume(&models[2], filepath, num_epochs, BENCHMARK_LEARNING_RATE);
+   const bool identical = !error && models[2].weight == models[0].weight &&
+      models[2].bias == models[0].bias;
+
+   printf("Checkpoint after %zu of %zu epochs (standardized), then resume\n", interrupted, num_epochs);
+   printf("--------------------------------------------------------------------------\n");
+   printf("%-16s %8s %24s %24s\n", "Run", "Epochs", "Weight", "Bias");
+   printf("%-16s %8zu %24.17g %24.17g\n", "uninterrupted", (size_t)models[0].epoch,
+          models[0].weight, models[0].bias);
+   printf("%-16s %8zu %24.17g %24.17g\n", "resumed", (size_t)models[2].epoch,
+          models[2].weight, models[2].bias);
+   printf("Resumed parameters %s the uninterrupted run.\n",
+          error ? "could not be compared with" : identical ? "are bit-identical to" : "DIFFER from");
+   printf("--------------------------------------------------------------------------\n\n");
+
+   for (size_t i = 0; i < 3; ++i)
+   {
+      lin_reg_delete(&models[i]);
+   }
+
+   remove(filepath);
+   return;
+}
+
+/**************************************************************************************************
+* benchmark_profile: Skriver angiven trningsdata till en temporr textfil, som sedan lses in
+*                    parallellt, trnas sekventiellt och anvnds som infil vid prediktion frn
+*                    fil till fil, dr hrdvarurknare mts per fas. Drefter skrivs tabellen
+*                    med tidstgng, IPC samt cachemissar och felpredikterade hopp per fas ut.
+*                    Sekventiell trning anvnds, eftersom hjlptrden vid pipelinad
+*                    randomisering gr att rknarvrdena inte kan delas upp per fas. Temporra
+*                    filer tas bort eftert.
+*
+*                    - train_in   : Pekare till array innehllande insignaler.
+*                    - train_out  : Pekare till array innehllande utsignaler.
+*                    - num_sets   : Antalet trningsuppsttningar.
+*                    - num_epochs : Antalet epoker vid trning.
+*                    - num_threads: Antalet trdar vid inlsning.
+**************************************************************************************************/
+static void benchmark_profile(const double* train_in,
+                              const double* train_out,
+                              const size_t num_sets,
+                              const size_t num_epochs,
+                              const size_t num_threads)
+{
+   const char* input_path = "benchmark_profile.tmp";
+   const char* output_path = "benchmark_profile_out.tmp";
+   struct perf_counters perf;
+   struct lin_reg l1;
+   FILE* fstream = fopen(input_path, "wb");
+   int error = !fstream;
+
+   for (size_t i = 0; i < num_sets && !error; ++i)
+   {
+      error = fprintf(fstream, "%.9f %.9f\n", train_in[i], train_out[i]) < 0;
+   }
+
+   if (fstream) error |= fclose(fstream) != 0;
+   printf("Hardware counters per phase (parallel load, sequential training, file scoring)\n");
+
+   if (error)
+   {
+      printf("--------------------------------------------------------------------------\n");
+      printf("Could not write temporary file at path %s!\n", input_path);
+      printf("--------------------------------------------------------------------------\n\n");
+      remove(input_path);
+      return;
+   }
+
+   perf_counters_new(&perf);
+   lin_reg_new(&l1);
+   lin_reg_set_perf_counters(&l1, &perf);
+   lin_reg_load_training_data_parallel(&l1, input_path, num_threads);
+   lin_reg_train(&l1, num_epochs, BENCHMARK_LEARNING_RATE);
+   lin_reg_score_file(&l1, input_path, output_path, SCORE_PIPELINE_FORMAT_TEXT, 0);
+   perf_counters_print(&perf, stdout);
+   lin_reg_delete(&l1);
+   perf_counters_delete(&perf);
+   remove(input_path);
+   remove(output_path);
+   return;
+}
+
+/**************************************************************************************************
+* benchmark_print: Skriver ut resultatet fr en trningsmetod i terminalen.
+*
+*                  - name       : Trningsmetodens namn.
+*                  - num_threads: Antalet trdar som anvndes vid trning.
+*                  - seconds    : Tidstgngen fr trningen i sekunder.
+*                  - model      : Pekare till den trnade regressionsmodellen.
+**************************************************************************************************/
+static void benchmark_print(const char* name,
+                            const size_t num_threads,
+                            const double seconds,
+                            const struct lin_reg* model)
+{
+   printf("%-20s %8zu %12.4f %14.6g %12.6f %12.6f\n", name, num_threads, seconds,
+          lin_reg_mean_squared_error(model), model->weight, model->bias);
+   return;
+}
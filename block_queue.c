@@ -0,0 +1,166 @@
+/**************************************************************************************************
+* block_queue.c: Innehller funktionsdefinitioner fr implementering av begrnsade ringbuffertar
+*                fr verfring av datablock mellan trdar via strukten block_queue.
+**************************************************************************************************/
+#include "block_queue.h"
+
+/**************************************************************************************************
+* block_queue_new: Initierar angiven ringbuffert med angivet antal block av angiven storlek.
+*                  Returnerar 0 vid lyckad initiering, annars 1.
+*
+*                  - self      : Pekare till ringbufferten.
+*                  - block_size: Respektive blocks kapacitet i byte.
+*                  - capacity  : Antalet block i ringbufferten.
+*                  - owner     : Delsystemet som ringbuffertens minne redovisas fr.
+**************************************************************************************************/
+int block_queue_new(struct block_queue* self,
+                    const size_t block_size,
+                    const size_t capacity,
+                    const enum mem_subsystem owner)
+{
+   self->data = (char*)MEM_MALLOC(owner, block_size * capacity);
+   self->sizes = (size_t*)MEM_MALLOC(owner, sizeof(size_t) * capacity);
+   self->owner = owner;
+   self->block_size = block_size;
+   self->capacity = capacity;
+   self->head = 0;
+   self->count = 0;
+   self->closed = false;
+
+   if (!self->data || !self->sizes)
+   {
+      MEM_FREE(owner, self->data);
+      MEM_FREE(owner, self->sizes);
+      self->data = 0;
+      self->sizes = 0;
+      return 1;
+   }
+
+   pthread_mutex_init(&self->mutex, 0);
+   pthread_cond_init(&self->not_empty, 0);
+   pthread_cond_init(&self->not_full, 0);
+   return 0;
+}
+
+/**************************************************************************************************
+* block_queue_delete: Frigr minnet fr angiven ringbuffert. Ingen trd fr anvnda bufferten
+*                     nr denna funktion anropas.
+*
+*                     - self: Pekare till ringbufferten.
+**************************************************************************************************/
+void block_queue_delete(struct block_queue* self)
+{
+   pthread_mutex_destroy(&self->mutex);
+   pthread_cond_destroy(&self->not_empty);
+   pthread_cond_destroy(&self->not_full);
+   MEM_FREE(self->owner, self->data);
+   MEM_FREE(self->owner, self->sizes);
+   self->data = 0;
+   self->sizes = 0;
+   self->capacity = 0;
+   self->count = 0;
+   return;
+}
+
+/**************************************************************************************************
+* block_queue_acquire: Returnerar en pekare till nsta lediga block, som producenten kan fylla
+*                      med upp till block_size byte. Anropet blockeras tills ett block r ledigt.
+*                      Ifall bufferten har stngts (exempelvis av konsumenten) returneras null.
+*
+*                      - self: Pekare till ringbufferten.
+**************************************************************************************************/
+char* block_queue_acquire(struct block_queue* self)
+{
+   pthread_mutex_lock(&self->mutex);
+
+   while (self->count == self->capacity && !self->closed)
+   {
+      pthread_cond_wait(&self->not_full, &self->mutex);
+   }
+
+   char* block = self->closed ? 0 :
+      self->data + ((self->head + self->count) % self->capacity) * self->block_size;
+   pthread_mutex_unlock(&self->mutex);
+   return block;
+}
+
+/**************************************************************************************************
+* block_queue_commit: Markerar blocket som senast returnerades av block_queue_acquire som fyllt,
+*                     vilket gr det tillgngligt fr konsumenten.
+*
+*                     - self: Pekare till ringbufferten.
+*                     - size: Antalet byte som har skrivits till blocket.
+**************************************************************************************************/
+void block_queue_commit(struct block_queue* self,
+                        const size_t size)
+{
+   pthread_mutex_lock(&self->mutex);
+   self->sizes[(self->head + self->count) % self->capacity] = size;
+   self->count++;
+   pthread_cond_signal(&self->not_empty);
+   pthread_mutex_unlock(&self->mutex);
+   return;
+}
+
+/**************************************************************************************************
+* block_queue_front: Returnerar en pekare till det ldsta fyllda blocket och lagrar dess storlek
+*                    via angiven pekare. Anropet blockeras tills ett block har fyllts. Ifall
+*                    bufferten har stngts och samtliga block har behandlats returneras null.
+*
+*                    - self: Pekare till ringbufferten.
+*                    - size: Pekare till variabel dr blockets storlek i byte lagras.
+**************************************************************************************************/
+const char* block_queue_front(struct block_queue* self,
+                              size_t* size)
+{
+   pthread_mutex_lock(&self->mutex);
+
+   while (!self->count && !self->closed)
+   {
+      pthread_cond_wait(&self->not_empty, &self->mutex);
+   }
+
+   const char* block = 0;
+
+   if (self->count)
+   {
+      block = self->data + self->head * self->block_size;
+      *size = self->sizes[self->head];
+   }
+
+   pthread_mutex_unlock(&self->mutex);
+   return block;
+}
+
+/**************************************************************************************************
+* block_queue_release: Frigr blocket som senast returnerades av block_queue_front, s att
+*                      producenten kan fylla det p nytt.
+*
+*                      - self: Pekare till ringbufferten.
+**************************************************************************************************/
+void block_queue_release(struct block_queue* self)
+{
+   pthread_mutex_lock(&self->mutex);
+   self->head = (self->head + 1) % self->capacity;
+   self->count--;
+   pthread_cond_signal(&self->not_full);
+   pthread_mutex_unlock(&self->mutex);
+   return;
+}
+
+/**************************************************************************************************
+* block_queue_close: Stnger angiven ringbuffert. Producenten anropar funktionen nr samtliga
+*                    block har fyllts, medan konsumenten kan anropa den fr att avbryta
+*                    producenten i frtid. Redan fyllda block kan fortfarande hmtas.
+*
+*                    - self: Pekare till ringbufferten.
+**************************************************************************************************/
+void block_queue_close(struct block_queue* self)
+{
+   pthread_mutex_lock(&self->mutex);
+   self->closed = true;
+   pthread_cond_broadcast(&self->not_empty);
+   pthread_cond_broadcast(&self->not_full);
+   pthread_mutex_unlock(&self->mutex);
+   return;
+}
@@ -0,0 +1,52 @@
+/**************************************************************************************************
+* block_queue.h: Implementering av begrnsade ringbuffertar fr verfring av datablock mellan
+*                tv trdar via strukten block_queue samt motsvarande externa funktioner. En
+*                producenttrd fyller lediga block medan en konsumenttrd behandlar fyllda block
+*                i samma ordning, vilket mjliggr att exempelvis dekomprimering och tolkning av
+*                trningsdata kan ske samtidigt i olika steg.
+**************************************************************************************************/
+#ifndef BLOCK_QUEUE_H_
+#define BLOCK_QUEUE_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "mem_stats.h"
+
+/**************************************************************************************************
+* block_queue: Ringbuffert innehllande ett fast antal frallokerade block av samma storlek.
+*              Blocken teranvnds, s minnestgngen r konstant oavsett datamngd. Producenten
+*              blockeras nr samtliga block r fyllda och konsumenten nr samtliga block r lediga.
+**************************************************************************************************/
+struct block_queue
+{
+   char* data;                /* Pekare till dynamiskt flt innehllande samtliga block. */
+   size_t* sizes;             /* Antalet lagrade byte i respektive block. */
+   size_t block_size;         /* Respektive blocks kapacitet i byte. */
+   size_t capacity;           /* Antalet block i ringbufferten. */
+   size_t head;               /* Index fr det ldsta fyllda blocket. */
+   size_t count;              /* Antalet fyllda block. */
+   bool closed;               /* Indikerar ifall ringbufferten har stngts. */
+   enum mem_subsystem owner;  /* Delsystemet som ringbuffertens minne redovisas fr. */
+   pthread_mutex_t mutex;     /* Mutex fr synkronisering av producent och konsument. */
+   pthread_cond_t not_empty;  /* Signaleras nr ett block har fyllts eller bufferten stngs. */
+   pthread_cond_t not_full;   /* Signaleras nr ett block har frigjorts eller bufferten stngs. */
+};
+
+/* Externa funktioner: */
+int block_queue_new(struct block_queue* self,
+                    const size_t block_size,
+                    const size_t capacity,
+                    const enum mem_subsystem owner);
+void block_queue_delete(struct block_queue* self);
+char* block_queue_acquire(struct block_queue* self);
+void block_queue_commit(struct block_queue* self,
+                        const size_t size);
+const char* block_queue_front(struct block_queue* self,
+                              size_t* size);
+void block_queue_release(struct block_queue* self);
+void block_queue_close(struct block_queue* self);
+
+#endif /* BLOCK_QUEUE_H_ */
@@ -0,0 +1,274 @@
+/**************************************************************************************************
+* checkpoint.c: Innehller funktionsdefinitioner fr periodiska kontrollpunkter under trning
+*               via strukten checkpoint.
+**************************************************************************************************/
+#include "checkpoint.h"
+
+/* Makrodefinitioner: */
+#define CHECKPOINT_MAGIC 0x5043524cU /* Filens identifierare ("LRCP"). */
+#define CHECKPOINT_VERSION 1U        /* Filformatets version. */
+
+// Statiska funktioner:
+static void* checkpoint_run(void* arg);
+
+/**************************************************************************************************
+* checkpoint_new: Initierar angiven kontrollpunktsstrukt. Returnerar 0 vid lyckad initiering,
+*                 annars 1.
+*
+*                 - self            : Pekare till strukten.
+*                 - filepath        : Filskvg som kontrollpunkter skall skrivas till.
+*                 - interval_epochs : Antalet epoker mellan kontrollpunkter (0 = av).
+*                 - interval_seconds: Antalet sekunder mellan kontrollpunkter (0 = av).
+**************************************************************************************************/
+int checkpoint_new(struct checkpoint* self,
+                   const char* filepath,
+                   const size_t interval_epochs,
+                   const double interval_seconds)
+{
+   self->filepath = (char*)MEM_MALLOC(MEM_SUBSYSTEM_TRAINING, strlen(filepath) + 1);
+   if (!self->filepath) return 1;
+   strcpy(self->filepath, filepath);
+   self->interval_epochs = interval_epochs;
+   self->interval_seconds = interval_seconds;
+   self->last_epoch = 0;
+   clock_gettime(CLOCK_MONOTONIC, &self->last_time);
+   uint_vector_new(&self->snapshot.order);
+   self->started = false;
+   atomic_init(&self->writing, false);
+   self->error = 0;
+   return 0;
+}
+
+/**************************************************************************************************
+* checkpoint_delete: Vntar tills eventuell pgende skrivning r klar och frigr drefter
+*                    minnet fr angiven kontrollpunktsstrukt.
+*
+*                    - self: Pekare till strukten.
+**************************************************************************************************/
+void checkpoint_delete(struct checkpoint* self)
+{
+   checkpoint_wait(self);
+   uint_vector_delete(&self->snapshot.order);
+   MEM_FREE(MEM_SUBSYSTEM_TRAINING, self->filepath);
+   self->filepath = 0;
+   return;
+}
+
+/**************************************************************************************************
+* checkpoint_due: Indikerar ifall en kontrollpunkt skall tas efter angiven epok, vilket r fallet
+*                 nr angivet antal epoker och/eller sekunder har passerat sedan fregende
+*                 kontrollpunkt.
+*
+*                 - self : Pekare till strukten.
+*                 - epoch: Antalet genomfrda epoker.
+**************************************************************************************************/
+bool checkpoint_due(const struct checkpoint* self,
+                    const uint64_t epoch)
+{
+   if (self->interval_epochs && epoch - self->last_epoch >= self->interval_epochs) return true;
+   if (self->interval_seconds > 0 && perf_counters_elapsed(&self->last_time) >= self->interval_seconds) return true;
+   return false;
+}
+
+/**************************************************************************************************
+* checkpoint_save_async: Kopierar angivet trningstillstnd till en gonblicksbild och startar
+*                        en skrivtrd som skriver gonblicksbilden till fil. Ifall fregende
+*                        skrivning fortfarande pgr grs ingenting och 1 returneras, s att
+*                        kontrollpunkten kan tas vid ett senare tillflle. Annars returneras 0.
+*
+*                        - self        : Pekare till strukten.
+*                        - weight      : Modellens lutning.
+*                        - bias        : Modellens vilovrde.
+*                        - standardized: Indikerar ifall parametrarna r i standardiserad rymd.
+*                        - epoch       : Antalet genomfrda epoker.
+*                        - rng_state   : Slumpgeneratorns tillstnd.
+*                        - order       : Pekare till trningsuppsttningarnas ordningsfljd.
+**************************************************************************************************/
+int checkpoint_save_async(struct checkpoint* self,
+                          const double weight,
+                          const double bias,
+                          const bool standardized,
+                          const uint64_t epoch,
+                          const uint64_t rng_state,
+                          const struct uint_vector* order)
+{
+   if (atomic_load(&self->writing)) return 1;
+   checkpoint_wait(self);
+
+   if (self->snapshot.order.size != order->size &&
+       uint_vector_resize(&self->snapshot.order, order->size))
+   {
+      return 1;
+   }
+
+   memcpy(self->snapshot.order.data, order->data, sizeof(size_t) * order->size);
+   self->snapshot.weight = weight;
+   self->snapshot.bias = bias;
+   self->snapshot.standardized = standardized;
+   self->snapshot.epoch = epoch;
+   self->snapshot.rng_state = rng_state;
+   self->last_epoch = epoch;
+   clock_gettime(CLOCK_MONOTONIC, &self->last_time);
+   atomic_store(&self->writing, true);
+
+   if (pthread_create(&self->thread, 0, &checkpoint_run, self))
+   {
+      checkpoint_run(self);
+   }
+   else
+   {
+      self->started = true;
+   }
+
+   return 0;
+}
+
+/**************************************************************************************************
+* checkpoint_wait: Vntar tills eventuell pgende skrivning r klar. Returnerar 0 ifall senaste
+*                  skrivning lyckades, annars 1.
+*
+*                  - self: Pekare till strukten.
+**************************************************************************************************/
+int checkpoint_wait(struct checkpoint* self)
+{
+   if (self->started)
+   {
+      pthread_join(self->thread, 0);
+      self->started = false;
+   }
+
+   return self->error;
+}
+
+/**************************************************************************************************
+* checkpoint_write: Skriver angivet trningstillstnd till en temporr fil, som sedan dps om
+*                   till angiven filskvg. Eftersom omdpningen sker atomiskt innehller
+*                   filskvgen alltid antingen fregende eller ny komplett kontrollpunkt.
+*                   Returnerar 0 vid lyckad skrivning, annars 1.
+*
+*                   - filepath: Filskvg som kontrollpunkten skall skrivas till.
+*                   - state   : Pekare till trningstillstndet.
+**************************************************************************************************/
+int checkpoint_write(const char* filepath,
+                     const struct checkpoint_state* state)
+{
+   const uint32_t header[2] = { CHECKPOINT_MAGIC, CHECKPOINT_VERSION };
+   const uint64_t size = state->order.size;
+   const uint64_t standardized = state->standardized;
+   char* temp_path = (char*)MEM_MALLOC(MEM_SUBSYSTEM_TRAINING, strlen(filepath) + 5);
+   FILE* fstream = 0;
+   int error = 0;
+
+   if (!temp_path) return 1;
+   strcpy(temp_path, filepath);
+   strcat(temp_path, ".tmp");
+   fstream = fopen(temp_path, "wb");
+
+   if (!fstream)
+   {
+      MEM_FREE(MEM_SUBSYSTEM_TRAINING, temp_path);
+      return 1;
+   }
+
+   error |= fwrite(header, sizeof(header), 1, fstream) != 1;
+   error |= fwrite(&state->epoch, sizeof(state->epoch), 1, fstream) != 1;
+   error |= fwrite(&state->rng_state, sizeof(state->rng_state), 1, fstream) != 1;
+   error |= fwrite(&state->weight, sizeof(state->weight), 1, fstream) != 1;
+   error |= fwrite(&state->bias, sizeof(state->bias), 1, fstream) != 1;
+   error |= fwrite(&standardized, sizeof(standardized), 1, fstream) != 1;
+   error |= fwrite(&size, sizeof(size), 1, fstream) != 1;
+
+   if (sizeof(size_t) == sizeof(uint64_t))
+   {
+      error |= fwrite(state->order.data, sizeof(size_t), state->order.size, fstream) != state->order.size;
+   }
+   else
+   {
+      for (size_t i = 0; i < state->order.size && !error; ++i)
+      {
+         const uint64_t index = state->order.data[i];
+         error |= fwrite(&index, sizeof(index), 1, fstream) != 1;
+      }
+   }
+
+   error |= fflush(fstream) != 0;
+   error |= fsync(fileno(fstream)) != 0;
+   error |= fclose(fstream) != 0;
+   if (!error) error = rename(temp_path, filepath) != 0;
+   if (error) remove(temp_path);
+   MEM_FREE(MEM_SUBSYSTEM_TRAINING, temp_path);
+   return error;
+}
+
+/**************************************************************************************************
+* checkpoint_read: Lser in ett trningstillstnd frn angiven kontrollpunktsfil. Ordningsfljden
+*                  lagras i tillstndets vektor, som mste vara initierad. Returnerar 0 vid
+*                  lyckad inlsning, annars 1 (exempelvis vid felaktigt eller trunkerat format).
+*
+*                  - filepath: Filskvg till kontrollpunktsfilen.
+*                  - state   : Pekare till trningstillstndet som skall fyllas i.
+**************************************************************************************************/
+int checkpoint_read(const char* filepath,
+                    struct checkpoint_state* state)
+{
+   uint32_t header[2] = { 0 };
+   uint64_t size = 0;
+   uint64_t standardized = 0;
+   FILE* fstream = fopen(filepath, "rb");
+   int error = 0;
+
+   if (!fstream) return 1;
+
+   error |= fread(header, sizeof(header), 1, fstream) != 1;
+   error |= header[0] != CHECKPOINT_MAGIC || header[1] != CHECKPOINT_VERSION;
+   error |= fread(&state->epoch, sizeof(state->epoch), 1, fstream) != 1;
+   error |= fread(&state->rng_state, sizeof(state->rng_state), 1, fstream) != 1;
+   error |= fread(&state->weight, sizeof(state->weight), 1, fstream) != 1;
+   error |= fread(&state->bias, sizeof(state->bias), 1, fstream) != 1;
+   error |= fread(&standardized, sizeof(standardized), 1, fstream) != 1;
+   state->standardized = standardized != 0;
+   error |= fread(&size, sizeof(size), 1, fstream) != 1;
+   if (!error) error = uint_vector_resize(&state->order, (size_t)size);
+
+   if (sizeof(size_t) == sizeof(uint64_t))
+   {
+      if (!error) error = fread(state->order.data, sizeof(size_t), (size_t)size, fstream) != size;
+   }
+   else
+   {
+      for (size_t i = 0; i < size && !error; ++i)
+      {
+         uint64_t index = 0;
+         error |= fread(&index, sizeof(index), 1, fstream) != 1;
+         if (!error) state->order.data[i] = (size_t)index;
+      }
+   }
+
+   for (size_t i = 0; i < size && !error; ++i)
+   {
+      error |= state->order.data[i] >= size;
+   }
+
+   fclose(fstream);
+   return error;
+}
+
+/**************************************************************************************************
+* checkpoint_run: Trdfunktion som skriver gonblicksbilden till fil och drefter markerar att
+*                 skrivningen r klar. Returnerar alltid null.
+*
+*                 - arg: Pekare till kontrollpunktsstrukten (struct checkpoint).
+**************************************************************************************************/
+static void* checkpoint_run(void* arg)
+{
+   struct checkpoint* self = (struct checkpoint*)arg;
+   self->error = checkpoint_write(self->filepath, &self->snapshot);
+
+   if (self->error)
+   {
+      fprintf(stderr, "Could not write checkpoint to path %s!\n\n", self->filepath);
+   }
+
+   atomic_store(&self->writing, false);
+   return 0;
+}
@@ -0,0 +1,84 @@
+/**************************************************************************************************
+* checkpoint.h: Implementering av periodiska kontrollpunkter under trning via strukten
+*               checkpoint samt motsvarande externa funktioner. En kontrollpunkt innehller allt
+*               som krvs fr att teruppta trningen bitidentiskt: modellens parametrar, antalet
+*               genomfrda epoker, slumpgeneratorns tillstnd samt aktuell ordningsfljd. Vid
+*               standardiserad trning lagras parametrarna i standardiserad rymd tillsammans med
+*               en flagga, s att trningen kan terupptas utan att parametrarna rknas om.
+*               Kontrollpunkter skrivs i en separat trd till en temporr fil, som sedan dps om
+*               till angiven filskvg, s att en avbruten skrivning aldrig frstr fregende
+*               kontrollpunkt.
+**************************************************************************************************/
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "uint_vector.h"
+#include "perf_counters.h"
+#include "mem_stats.h"
+
+/**************************************************************************************************
+* checkpoint_state: Trningstillstnd som lagras i en kontrollpunkt.
+**************************************************************************************************/
+struct checkpoint_state
+{
+   double weight;            /* Modellens lutning (k-vrde). */
+   double bias;              /* Modellens vilovrde (m-vrde). */
+   bool standardized;        /* Indikerar ifall parametrarna r i standardiserad rymd. */
+   uint64_t epoch;           /* Antalet genomfrda epoker. */
+   uint64_t rng_state;       /* Slumpgeneratorns tillstnd. */
+   struct uint_vector order; /* Trningsuppsttningarnas aktuella ordningsfljd. */
+};
+
+/**************************************************************************************************
+* checkpoint: Strukt fr periodisk skrivning av kontrollpunkter var N:e epok och/eller var T:e
+*             sekund. Tillstndet kopieras till en gonblicksbild, som skrivs till fil av en
+*             separat trd medan trningen fortstter. Ifall fregende skrivning fortfarande
+*             pgr nr en ny kontrollpunkt skall tas skjuts denna upp till nsta epok, s att
+*             trningen aldrig behver vnta p disken.
+**************************************************************************************************/
+struct checkpoint
+{
+   char* filepath;                   /* Filskvg till kontrollpunktsfilen. */
+   size_t interval_epochs;           /* Antalet epoker mellan kontrollpunkter (0 = av). */
+   double interval_seconds;          /* Antalet sekunder mellan kontrollpunkter (0 = av). */
+   uint64_t last_epoch;              /* Epok fr senaste kontrollpunkt. */
+   struct timespec last_time;        /* Tidpunkt fr senaste kontrollpunkt. */
+   struct checkpoint_state snapshot; /* gonblicksbild som skrivs av skrivtrden. */
+   pthread_t thread;                 /* Skrivtrden. */
+   bool started;                     /* Indikerar ifall skrivtrden har startats. */
+   atomic_bool writing;              /* Indikerar ifall en skrivning pgr. */
+   int error;                        /* Indikerar ifall senaste skrivning misslyckades. */
+};
+
+/* Externa funktioner: */
+int checkpoint_new(struct checkpoint* self,
+                   const char* filepath,
+                   const size_t interval_epochs,
+                   const double interval_seconds);
+void checkpoint_delete(struct checkpoint* self);
+bool checkpoint_due(const struct checkpoint* self,
+                    const uint64_t epoch);
+int checkpoint_save_async(struct checkpoint* self,
+                          const double weight,
+                          const double bias,
+                          const bool standardized,
+                          const uint64_t epoch,
+                          const uint64_t rng_state,
+                          const struct uint_vector* order);
+int checkpoint_wait(struct checkpoint* self);
+int checkpoint_write(const char* filepath,
+                     const struct checkpoint_state* state);
+int checkpoint_read(const char* filepath,
+                    struct checkpoint_state* state);
+
+#endif /* CHECKPOINT_H_ */
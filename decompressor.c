@@ -0,0 +1,353 @@
+/**************************************************************************************************
+* decompressor.c: Innehller funktionsdefinitioner fr strmmande dekomprimering av filer
+*                 komprimerade med gzip eller zstd via strukten decompressor. Okomprimerade
+*                 filer kopieras blockvis rakt av till ringbufferten.
+**************************************************************************************************/
+#include "decompressor.h"
+
+#ifdef LIN_REG_USE_ZLIB
+#include <zlib.h>
+#endif /* LIN_REG_USE_ZLIB */
+
+#ifdef LIN_REG_USE_ZSTD
+#include <zstd.h>
+#endif /* LIN_REG_USE_ZSTD */
+
+/* Makrodefinitioner: */
+#define DECOMPRESSOR_INPUT_SIZE (256 * 1024) /* Blockstorlek vid lsning av komprimerad data. */
+
+// Statiska funktioner:
+static void* decompressor_run(void* arg);
+static int decompressor_copy(struct decompressor* self);
+
+#ifdef LIN_REG_USE_ZLIB
+static int decompressor_gzip(struct decompressor* self,
+                             unsigned char* input);
+#endif /* LIN_REG_USE_ZLIB */
+
+#ifdef LIN_REG_USE_ZSTD
+static int decompressor_zstd(struct decompressor* self,
+                             unsigned char* input);
+#endif /* LIN_REG_USE_ZSTD */
+
+/**************************************************************************************************
+* decompressor_detect: Identifierar angiven filstrms komprimeringsformat via de frsta byten
+*                      i filen (s kallade magiska tal). Filstrmmen spolas sedan tillbaka till
+*                      brjan, s att hela filen kan lsas in drefter.
+*
+*                      - fstream: Pekare till filstrmmen, som mste vara ppnad i binrt lge.
+**************************************************************************************************/
+enum decompressor_format decompressor_detect(FILE* fstream)
+{
+   unsigned char magic[4] = { 0 };
+   const size_t num_read = fread(magic, 1, sizeof(magic), fstream);
+   enum decompressor_format format = DECOMPRESSOR_FORMAT_NONE;
+   rewind(fstream);
+
+   if (num_read >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+   {
+      format = DECOMPRESSOR_FORMAT_GZIP;
+   }
+   else if (num_read == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f &&
+            magic[3] == 0xfd)
+   {
+      format = DECOMPRESSOR_FORMAT_ZSTD;
+   }
+
+   return format;
+}
+
+/**************************************************************************************************
+* decompressor_supported: Indikerar ifall angivet komprimeringsformat stds av aktuell build.
+*                         Okomprimerade filer stds alltid.
+*
+*                         - format: Komprimeringsformatet som skall kontrolleras.
+**************************************************************************************************/
+bool decompressor_supported(const enum decompressor_format format)
+{
+   switch (format)
+   {
+   case DECOMPRESSOR_FORMAT_NONE:
+      return true;
+#ifdef LIN_REG_USE_ZLIB
+   case DECOMPRESSOR_FORMAT_GZIP:
+      return true;
+#endif /* LIN_REG_USE_ZLIB */
+#ifdef LIN_REG_USE_ZSTD
+   case DECOMPRESSOR_FORMAT_ZSTD:
+      return true;
+#endif /* LIN_REG_USE_ZSTD */
+   default:
+      return false;
+   }
+}
+
+/**************************************************************************************************
+* decompressor_format_name: Returnerar namnet p angivet komprimeringsformat som text.
+*
+*                           - format: Komprimeringsformatet vars namn skall returneras.
+**************************************************************************************************/
+const char* decompressor_format_name(const enum decompressor_format format)
+{
+   switch (format)
+   {
+   case DECOMPRESSOR_FORMAT_GZIP:
+      return "gzip";
+   case DECOMPRESSOR_FORMAT_ZSTD:
+      return "zstd";
+   default:
+      return "none";
+   }
+}
+
+/**************************************************************************************************
+* decompressor_start: Startar dekomprimering av angiven filstrm i en separat trd. Dekomprimerad
+*                     data skrivs till angiven ringbuffert, som stngs nr filen r slut.
+*                     Returnerar 0 ifall trden startades, annars 1 (exempelvis ifall formatet
+*                     inte stds), dr ringbufferten d stngs direkt.
+*
+*                     - self   : Pekare till dekomprimeraren.
+*                     - fstream: Pekare till filstrmmen som skall dekomprimeras.
+*                     - format : Filstrmmens komprimeringsformat.
+*                     - queue  : Pekare till ringbufferten som dekomprimerad data skrivs till.
+**************************************************************************************************/
+int decompressor_start(struct decompressor* self,
+                       FILE* fstream,
+                       const enum decompressor_format format,
+                       struct block_queue* queue)
+{
+   self->fstream = fstream;
+   self->format = format;
+   self->queue = queue;
+   self->error = 0;
+
+   if (!decompressor_supported(format) || pthread_create(&self->thread, 0, &decompressor_run, self))
+   {
+      self->error = 1;
+      self->queue = 0;
+      block_queue_close(queue);
+      return 1;
+   }
+
+   return 0;
+}
+
+/**************************************************************************************************
+* decompressor_join: Vntar tills angiven dekomprimerare r klar. Returnerar 0 ifall hela filen
+*                    dekomprimerades, annars 1 (exempelvis vid korrupt eller trunkerad fil).
+*
+*                    - self: Pekare till dekomprimeraren.
+**************************************************************************************************/
+int decompressor_join(struct decompressor* self)
+{
+   if (self->queue)
+   {
+      pthread_join(self->thread, 0);
+      self->queue = 0;
+   }
+
+   return self->error;
+}
+
+/**************************************************************************************************
+* decompressor_run: Trdfunktion som dekomprimerar filstrmmen enligt angivet format och
+*                   stnger ringbufferten nr dekomprimeringen r klar. Indatabufferten
+*                   redovisas fr samma delsystem som ringbufferten. Returnerar alltid null.
+*
+*                   - arg: Pekare till dekomprimeraren (struct decompressor).
+**************************************************************************************************/
+static void* decompressor_run(void* arg)
+{
+   struct decompressor* self = (struct decompressor*)arg;
+   unsigned char* input = (unsigned char*)MEM_MALLOC(self->queue->owner, DECOMPRESSOR_INPUT_SIZE);
+
+   if (!input)
+   {
+      self->error = 1;
+   }
+   else if (self->format == DECOMPRESSOR_FORMAT_NONE)
+   {
+      self->error = decompressor_copy(self);
+   }
+#ifdef LIN_REG_USE_ZLIB
+   else if (self->format == DECOMPRESSOR_FORMAT_GZIP)
+   {
+      self->error = decompressor_gzip(self, input);
+   }
+#endif /* LIN_REG_USE_ZLIB */
+#ifdef LIN_REG_USE_ZSTD
+   else if (self->format == DECOMPRESSOR_FORMAT_ZSTD)
+   {
+      self->error = decompressor_zstd(self, input);
+   }
+#endif /* LIN_REG_USE_ZSTD */
+
+   MEM_FREE(self->queue->owner, input);
+   block_queue_close(self->queue);
+   return 0;
+}
+
+/**************************************************************************************************
+* decompressor_copy: Kopierar en okomprimerad filstrm blockvis till ringbufferten, dr varje
+*                    block lses direkt in i ringbufferten utan mellanlagring. Returnerar 0
+*                    ifall hela filen lstes, annars 1.
+*
+*                    - self: Pekare till dekomprimeraren.
+**************************************************************************************************/
+static int decompressor_copy(struct decompressor* self)
+{
+   char* block = 0;
+
+   while ((block = block_queue_acquire(self->queue)))
+   {
+      const size_t size = fread(block, 1, self->queue->block_size, self->fstream);
+      if (size) block_queue_commit(self->queue, size);
+      if (size < self->queue->block_size) break;
+   }
+
+   return ferror(self->fstream) != 0;
+}
+
+#ifdef LIN_REG_USE_ZLIB
+/**************************************************************************************************
+* decompressor_gzip: Dekomprimerar en gzip-komprimerad filstrm till ringbufferten. Filer
+*                    bestende av flera sammanfogade gzip-strmmar stds. Returnerar 0 ifall
+*                    hela filen dekomprimerades, annars 1.
+*
+*                    - self : Pekare till dekomprimeraren.
+*                    - input: Pekare till buffert fr komprimerad data.
+**************************************************************************************************/
+static int decompressor_gzip(struct decompressor* self,
+                             unsigned char* input)
+{
+   z_stream stream = { 0 };
+   char* block = block_queue_acquire(self->queue);
+   bool eof = false;
+   bool finished = false;
+   int error = 0;
+
+   if (!block) return 0;
+   if (inflateInit2(&stream, 15 + 32) != Z_OK) return 1;
+   stream.next_out = (Bytef*)block;
+   stream.avail_out = (uInt)self->queue->block_size;
+
+   while (true)
+   {
+      if (!stream.avail_in && !eof)
+      {
+         stream.avail_in = (uInt)fread(input, 1, DECOMPRESSOR_INPUT_SIZE, self->fstream);
+         stream.next_in = input;
+         eof = !stream.avail_in;
+      }
+
+      const uInt avail_out = stream.avail_out;
+      const int status = inflate(&stream, Z_NO_FLUSH);
+
+      if (status == Z_STREAM_END)
+      {
+         finished = true;
+         inflateReset(&stream);
+      }
+      else if (status == Z_OK)
+      {
+         finished = false;
+      }
+      else if (status != Z_BUF_ERROR)
+      {
+         error = 1;
+         break;
+      }
+
+      if (!stream.avail_out)
+      {
+         block_queue_commit(self->queue, self->queue->block_size);
+         block = block_queue_acquire(self->queue);
+         if (!block) break;
+         stream.next_out = (Bytef*)block;
+         stream.avail_out = (uInt)self->queue->block_size;
+      }
+      else if (eof && !stream.avail_in && stream.avail_out == avail_out)
+      {
+         break;
+      }
+   }
+
+   if (block && stream.avail_out < self->queue->block_size)
+   {
+      block_queue_commit(self->queue, self->queue->block_size - stream.avail_out);
+   }
+
+   inflateEnd(&stream);
+   return error || (block && !finished);
+}
+#endif /* LIN_REG_USE_ZLIB */
+
+#ifdef LIN_REG_USE_ZSTD
+/**************************************************************************************************
+* decompressor_zstd: Dekomprimerar en zstd-komprimerad filstrm till ringbufferten. Returnerar
+*                    0 ifall hela filen dekomprimerades, annars 1.
+*
+*                    - self : Pekare till dekomprimeraren.
+*                    - input: Pekare till buffert fr komprimerad data.
+**************************************************************************************************/
+static int decompressor_zstd(struct decompressor* self,
+                             unsigned char* input)
+{
+   ZSTD_DStream* stream = ZSTD_createDStream();
+   char* block = block_queue_acquire(self->queue);
+   ZSTD_inBuffer in = { input, 0, 0 };
+   ZSTD_outBuffer out = { block, self->queue->block_size, 0 };
+   size_t status = 0;
+   bool eof = false;
+   int error = 0;
+
+   if (!stream) return 1;
+   if (!block)
+   {
+      ZSTD_freeDStream(stream);
+      return 0;
+   }
+
+   ZSTD_initDStream(stream);
+
+   while (true)
+   {
+      if (in.pos == in.size && !eof)
+      {
+         in.size = fread(input, 1, DECOMPRESSOR_INPUT_SIZE, self->fstream);
+         in.pos = 0;
+         eof = !in.size;
+      }
+
+      const size_t pos = out.pos;
+      status = ZSTD_decompressStream(stream, &out, &in);
+
+      if (ZSTD_isError(status))
+      {
+         error = 1;
+         break;
+      }
+
+      if (out.pos == out.size)
+      {
+         block_queue_commit(self->queue, out.size);
+         block = block_queue_acquire(self->queue);
+         if (!block) break;
+         out.dst = block;
+         out.pos = 0;
+      }
+      else if (eof && in.pos == in.size && out.pos == pos)
+      {
+         break;
+      }
+   }
+
+   if (block && out.pos)
+   {
+      block_queue_commit(self->queue, out.pos);
+   }
+
+   ZSTD_freeDStream(stream);
+   return error || (block && status != 0);
+}
+#endif /* LIN_REG_USE_ZSTD */
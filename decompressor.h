@@ -0,0 +1,55 @@
+/**************************************************************************************************
+* decompressor.h: Implementering av strmmande dekomprimering av filer komprimerade med gzip
+*                 eller zstd via strukten decompressor samt motsvarande externa funktioner.
+*                 Dekomprimeringen sker i en egen trd, dr dekomprimerad data skrivs blockvis
+*                 till en ringbuffert som konsumeras av en annan trd. Okomprimerade filer
+*                 kopieras blockvis rakt av, s att dekomprimeraren ven kan anvndas som
+*                 generellt lsningssteg i en pipeline.
+*
+*                 Std fr gzip aktiveras genom att kompilera med -DLIN_REG_USE_ZLIB -lz, medan
+*                 std fr zstd aktiveras genom att kompilera med -DLIN_REG_USE_ZSTD -lzstd.
+**************************************************************************************************/
+#ifndef DECOMPRESSOR_H_
+#define DECOMPRESSOR_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "block_queue.h"
+
+/**************************************************************************************************
+* decompressor_format: Enumeration fr filformat som kan identifieras av dekomprimeraren.
+**************************************************************************************************/
+enum decompressor_format
+{
+   DECOMPRESSOR_FORMAT_NONE, /* Okomprimerad fil. */
+   DECOMPRESSOR_FORMAT_GZIP, /* Fil komprimerad med gzip. */
+   DECOMPRESSOR_FORMAT_ZSTD  /* Fil komprimerad med zstd. */
+};
+
+/**************************************************************************************************
+* decompressor: Strukt fr dekomprimering av en filstrm i en separat trd. Dekomprimerad data
+*               skrivs till angiven ringbuffert, som stngs nr filen r slut eller vid fel.
+**************************************************************************************************/
+struct decompressor
+{
+   FILE* fstream;                   /* Pekare till filstrmmen som skall dekomprimeras. */
+   enum decompressor_format format; /* Filstrmmens komprimeringsformat. */
+   struct block_queue* queue;       /* Ringbuffert som dekomprimerad data skrivs till. */
+   pthread_t thread;                /* Trden som genomfr dekomprimeringen. */
+   int error;                       /* Indikerar ifall dekomprimeringen misslyckades. */
+};
+
+/* Externa funktioner: */
+enum decompressor_format decompressor_detect(FILE* fstream);
+bool decompressor_supported(const enum decompressor_format format);
+const char* decompressor_format_name(const enum decompressor_format format);
+int decompressor_start(struct decompressor* self,
+                       FILE* fstream,
+                       const enum decompressor_format format,
+                       struct block_queue* queue);
+int decompressor_join(struct decompressor* self);
+
+#endif /* DECOMPRESSOR_H_ */
@@ -23,7 +23,7 @@ void double_vector_new(struct double_vector* self)
 **************************************************************************************************/
 void double_vector_delete(struct double_vector* self)
 {
-   free(self->data);
+   MEM_FREE(MEM_SUBSYSTEM_DOUBLE_VECTOR, self->data);
    self->data = 0;
    self->size = 0;
    return;
@@ -36,7 +36,7 @@ void double_vector_delete(struct double_vector* self)
 **************************************************************************************************/
 struct double_vector* double_vector_ptr_new(const size_t size)
 {
-   struct double_vector* self = (struct double_vector*)malloc(sizeof(struct double_vector));
+   struct double_vector* self = (struct double_vector*)MEM_MALLOC(MEM_SUBSYSTEM_DOUBLE_VECTOR, sizeof(struct double_vector));
    if (!self) return 0;
    self->data = 0;
    self->size = 0;
@@ -54,7 +54,7 @@ struct double_vector* double_vector_ptr_new(const size_t size)
 void double_vector_ptr_delete(struct double_vector** self)
 {
    double_vector_delete(*self);
-   free(*self);
+   MEM_FREE(MEM_SUBSYSTEM_DOUBLE_VECTOR, *self);
    *self = 0;
    return;
 }
@@ -68,7 +68,7 @@ void double_vector_ptr_delete(struct double_vector** self)
 int double_vector_resize(struct double_vector* self,
                          const size_t new_size)
 {
-   double* copy = (double*)realloc(self->data, sizeof(double) * new_size);
+   double* copy = (double*)MEM_REALLOC(MEM_SUBSYSTEM_DOUBLE_VECTOR, self->data, sizeof(double) * new_size);
    if (!copy) return 1;
    self->data = copy;
    self->size = new_size;
@@ -84,7 +84,7 @@ int double_vector_resize(struct double_vector* self,
 int double_vector_push(struct double_vector* self,
                        const double new_element)
 {
-   double* copy = (double*)realloc(self->data, sizeof(double) * (self->size + 1));
+   double* copy = (double*)MEM_REALLOC(MEM_SUBSYSTEM_DOUBLE_VECTOR, self->data, sizeof(double) * (self->size + 1));
    if (!copy) return 1;
    copy[self->size++] = new_element;
    self->data = copy;
@@ -105,7 +105,7 @@ int double_vector_pop(struct double_vector* self)
    }
    else
    {
-      double* copy = (double*)realloc(self->data, sizeof(double) * (self->size - 1));
+      double* copy = (double*)MEM_REALLOC(MEM_SUBSYSTEM_DOUBLE_VECTOR, self->data, sizeof(double) * (self->size - 1));
       if (!copy) return 1;
       self->data = copy;
       self->size--;
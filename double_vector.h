@@ -8,6 +8,7 @@
 /* Inkluderingsdirektiv: */
 #include <stdio.h>
 #include <stdlib.h>
+#include "mem_stats.h"
 
 /**************************************************************************************************
 * double_vector: Vektor innehllande ett dynamiskt flt fr lagring av flyttal. Antalet element
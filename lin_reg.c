@@ -4,17 +4,137 @@
 **************************************************************************************************/
 #include "lin_reg.h"
 
+/* Makrodefinitioner: */
+#define LIN_REG_BLOCK_SIZE (1024 * 1024)          /* Blockstorlek vid inlsning frn fil. */
+#define LIN_REG_MIN_CHUNK_SIZE (4 * 1024 * 1024)  /* Minsta filstycke per inlsningstrd. */
+#define LIN_REG_QUEUE_CAPACITY 8                  /* Antalet block mellan dekomprimering och tolkning. */
+#define LIN_REG_DEFAULT_SEED 1                    /* Slumpgeneratorns startvrde som default. */
+#define LIN_REG_SCALE_PARTS 16                    /* Antalet delar vid berkning av skalning. */
+#define LIN_REG_PROGRESSIVE_Z 2.0                 /* Antal standardfel fr signifikant frbttring. */
+#define LIN_REG_PROGRESSIVE_PATIENCE 2            /* Antalet steg utan frbttring innan avslut. */
+#define LIN_REG_PROGRESSIVE_MIN_SIZE 1000         /* Minsta delmngd i frsta steget. */
+#define LIN_REG_PROGRESSIVE_MIN_HOLDOUT 1000      /* Minsta antal utvrderade uppsttningar. */
+
+/**************************************************************************************************
+* lin_reg_chunk: Beskriver ett stycke av en fil med trningsdata, som tolkas av en egen trd.
+*                Varje stycke ger de rader vars frsta tecken ligger inom intervallet
+*                [start, end), s att varje rad tolkas exakt en gng oavsett styckesgrnser.
+**************************************************************************************************/
+struct lin_reg_chunk
+{
+   const char* filepath;       /* Filskvg till filen som skall lsas in. */
+   off_t start;                /* Styckets startposition i filen. */
+   off_t end;                  /* Position direkt efter styckets sista tecken. */
+   struct train_buffer buffer; /* Buffert fr trningsuppsttningar tolkade ur stycket. */
+};
+
+/**************************************************************************************************
+* lin_reg_shuffle_task: Beskriver randomisering av nsta epoks ordningsfljd, som genomfrs av en
+*                       hjlptrd medan aktuell epok trnas. Aktuell ordningsfljd kopieras och
+*                       randomiseras sedan, vilket ger samma resultat som randomisering p plats.
+**************************************************************************************************/
+struct lin_reg_shuffle_task
+{
+   const size_t* source; /* Pekare till aktuell epoks ordningsfljd (lses endast). */
+   size_t* destination;  /* Pekare till flt dr nsta epoks ordningsfljd lagras. */
+   size_t size;          /* Antalet trningsuppsttningar. */
+   uint64_t* rng_state;  /* Pekare till slumpgeneratorns tillstnd. */
+};
+
+/**************************************************************************************************
+* lin_reg_hogwild_task: Beskriver en trds andel av asynkron trning, dr samtliga trdar
+*                       justerar gemensamma parametrar utan ls. Varje trd trnar p sin egen
+*                       del av trningsuppsttningarnas ordningsfljd.
+**************************************************************************************************/
+struct lin_reg_hogwild_task
+{
+   const struct lin_reg* model; /* Pekare till regressionsmodellen (trningsdata lses endast). */
+   _Atomic double* weight;      /* Pekare till gemensam lutning. */
+   _Atomic double* bias;        /* Pekare till gemensamt vilovrde. */
+   size_t* order;               /* Pekare till trdens del av ordningsfljden. */
+   size_t size;                 /* Antalet trningsuppsttningar i trdens del. */
+   size_t num_epochs;           /* Antalet epoker som skall genomfras. */
+   double learning_rate;        /* Lrhastighet vid justering av parametrarna. */
+   uint64_t rng_state;          /* Trdens egna slumpgeneratortillstnd. */
+};
+
+/**************************************************************************************************
+* lin_reg_moments: Antal, medelvrden samt summan av kvadratiska avvikelser frn medelvrdet fr
+*                  en del av trningsdatan. Delarna berknas parallellt och sls sedan samman.
+**************************************************************************************************/
+struct lin_reg_moments
+{
+   size_t count;    /* Antalet trningsuppsttningar. */
+   double mean_in;  /* Insignalernas medelvrde. */
+   double m2_in;    /* Summan av insignalernas kvadratiska avvikelser frn medelvrdet. */
+   double mean_out; /* Utsignalernas medelvrde. */
+   double m2_out;   /* Summan av utsignalernas kvadratiska avvikelser frn medelvrdet. */
+};
+
+/**************************************************************************************************
+* lin_reg_moments_task: Beskriver en trds andel av berkningen av trningsdatans skalning, dr
+*                       trden berknar var num_threads:e del med start p angiven del.
+**************************************************************************************************/
+struct lin_reg_moments_task
+{
+   const struct lin_reg* model;   /* Pekare till regressionsmodellen. */
+   struct lin_reg_moments* parts; /* Pekare till flt innehllande samtliga delars resultat. */
+   size_t first;                  /* Index fr trdens frsta del. */
+   size_t num_threads;            /* Antalet trdar. */
+};
+
 // Statiska funktioner:
-static void lin_reg_shuffle(struct lin_reg* self);
+static void lin_reg_shuffle(size_t* order,
+                            const size_t size,
+                            uint64_t* rng_state);
+static void* lin_reg_shuffle_next(void* arg);
+static uint64_t lin_reg_random(uint64_t* rng_state);
+static void lin_reg_train_epoch(struct lin_reg* self,
+                                const double learning_rate,
+                                const size_t num_sets);
+static void lin_reg_train_pipelined(struct lin_reg* self,
+                                    const size_t num_epochs,
+                                    const double learning_rate);
+static void lin_reg_checkpoint(struct lin_reg* self,
+                               const uint64_t rng_state);
+static void lin_reg_train_standardized(struct lin_reg* self,
+                                       const size_t num_epochs,
+                                       const double learning_rate,
+                                       const bool normalized);
+static void lin_reg_scale_compute(const struct lin_reg* self,
+                                  struct lin_reg_scale* scale);
+static void* lin_reg_moments_compute(void* arg);
+static void lin_reg_scale_fold(const struct lin_reg_scale* scale,
+                               const double weight,
+                               const double bias,
+                               double* folded_weight,
+                               double* folded_bias);
+static bool lin_reg_stage_improved(const struct lin_reg* self,
+                                   const double previous_weight,
+                                   const double previous_bias,
+                                   const size_t begin,
+                                   const size_t end,
+                                   const double tolerance);
+static void* lin_reg_train_hogwild_thread(void* arg);
 static void lin_reg_optimize(struct lin_reg* self,
                              const double input, 
                              const double reference,
                              const double learning_rate);
-static void lin_reg_extract(struct lin_reg* self, 
-                            const char* s);
-static bool char_is_digit(const char c);
-static void retrieve_double(struct double_vector* data, 
-                            char* s);
+static void lin_reg_load_file(struct lin_reg* self,
+                              const char* filepath,
+                              size_t num_threads);
+static void* lin_reg_load_chunk(void* arg);
+static void lin_reg_load_compressed(struct lin_reg* self,
+                                    FILE* fstream,
+                                    const enum decompressor_format format,
+                                    const char* filepath);
+static bool lin_reg_load_line(void* context,
+                              const char* begin,
+                              const char* end);
+static void lin_reg_append_chunks(struct lin_reg* self,
+                                  struct lin_reg_chunk* chunks,
+                                  const size_t num_chunks);
+static size_t lin_reg_num_cpus(void);
 
 /**************************************************************************************************
 * lin_reg_new: Initierar angiven regressionsmodell. Trningsdata mste tillfras i efterhand via 
@@ -31,6 +151,14 @@ void lin_reg_new(struct lin_reg* self)
    uint_vector_new(&self->train_order);
    self->bias = 0;
    self->weight = 0;
+   self->perf = 0;
+   self->rng_state = LIN_REG_DEFAULT_SEED;
+   self->pipelined_shuffle = false;
+   self->epoch = 0;
+   self->checkpoint = 0;
+   self->standardize = false;
+   self->scale = 0;
+   self->scale_cached = false;
    return;
 }
 
@@ -47,6 +175,14 @@ void lin_reg_delete(struct lin_reg* self)
    uint_vector_delete(&self->train_order);
    self->bias = 0;
    self->weight = 0;
+   self->perf = 0;
+   self->rng_state = LIN_REG_DEFAULT_SEED;
+   self->pipelined_shuffle = false;
+   self->epoch = 0;
+   self->checkpoint = 0;
+   self->standardize = false;
+   self->scale = 0;
+   self->scale_cached = false;
    return;
 }
 
@@ -58,7 +194,7 @@ void lin_reg_delete(struct lin_reg* self)
 **************************************************************************************************/
 struct lin_reg* lin_reg_ptr_new(void)
 {
-   struct lin_reg* self = (struct lin_reg*)malloc(sizeof(struct lin_reg));
+   struct lin_reg* self = (struct lin_reg*)MEM_MALLOC(MEM_SUBSYSTEM_MODEL, sizeof(struct lin_reg));
    if (!self) return 0;
    lin_reg_new(self);
    return self;
@@ -73,14 +209,112 @@ struct lin_reg* lin_reg_ptr_new(void)
 void lin_reg_ptr_delete(struct lin_reg** self)
 {
    lin_reg_delete(*self);
-   free(*self);
+   MEM_FREE(MEM_SUBSYSTEM_MODEL, *self);
    *self = 0;
    return;
 }
 
+/**************************************************************************************************
+* lin_reg_set_perf_counters: Aktiverar mtning av hrdvarurknare fr angiven regressionsmodell.
+*                            Drefter mts inlsning, randomisering, parameterjustering samt
+*                            prediktion, dr resultatet kan skrivas ut via perf_counters_print.
+*                            Strukten fr hrdvarurknarna gs av anroparen och mste leva
+*                            minst lika lnge som mtningen pgr. Rknarna rvs av nya
+*                            trdar, men en trds rknarvrden adderas frst nr trden
+*                            avslutas. Vid pipelinad randomisering avslutas hjlptrden oftast
+*                            medan parameterjusteringen mts, s randomiseringens rknarvrden
+*                            hamnar d huvudsakligen under update. Endast tidstgngen per fas
+*                            r tillfrlitlig i det lget, medan rknarvrden per fas br mtas
+*                            med ordinarie trning.
+*
+*                            - self: Pekare till regressionsmodellen.
+*                            - perf: Pekare till initierade hrdvarurknare (null = ingen mtning).
+**************************************************************************************************/
+void lin_reg_set_perf_counters(struct lin_reg* self,
+                               struct perf_counters* perf)
+{
+   self->perf = perf;
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_set_seed: Stter startvrdet fr den slumpgenerator som anvnds fr att randomisera
+*                   trningsuppsttningarnas ordningsfljd. Samma startvrde samt trningsdata
+*                   ger drmed identiska resultat vid varje krning.
+*
+*                   - self: Pekare till regressionsmodellen.
+*                   - seed: Slumpgeneratorns nya startvrde.
+**************************************************************************************************/
+void lin_reg_set_seed(struct lin_reg* self,
+                      const uint64_t seed)
+{
+   self->rng_state = seed;
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_set_pipelined_shuffle: Aktiverar eller inaktiverar pipelinad randomisering vid trning.
+*                                Nr pipelinad randomisering r aktiverad tas nsta epoks
+*                                ordningsfljd fram av en hjlptrd i ett separat flt medan
+*                                aktuell epok trnas, varefter flten byts vid epokgrnsen.
+*                                Resultatet blir identiskt med ordinarie trning, men p
+*                                bekostnad av ytterligare ett indexflt i minnet.
+*
+*                                - self             : Pekare till regressionsmodellen.
+*                                - pipelined_shuffle: Indikerar ifall pipelinad randomisering
+*                                                     skall anvndas.
+**************************************************************************************************/
+void lin_reg_set_pipelined_shuffle(struct lin_reg* self,
+                                   const bool pipelined_shuffle)
+{
+   self->pipelined_shuffle = pipelined_shuffle;
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_set_checkpoint: Aktiverar periodiska kontrollpunkter vid trning av angiven
+*                         regressionsmodell via lin_reg_train. Kontrollpunkterna tas efter
+*                         avslutad epok enligt de intervall som har angivits fr strukten och
+*                         skrivs till fil i en separat trd. Strukten gs av anroparen, som br
+*                         anropa checkpoint_wait efter trningen fr att invnta sista skrivningen.
+*
+*                         - self      : Pekare till regressionsmodellen.
+*                         - checkpoint: Pekare till initierad kontrollpunktsstrukt (null = av).
+**************************************************************************************************/
+void lin_reg_set_checkpoint(struct lin_reg* self,
+                            struct checkpoint* checkpoint)
+{
+   self->checkpoint = checkpoint;
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_set_standardize: Aktiverar eller inaktiverar standardisering vid trning via
+*                          lin_reg_train. Vid standardisering berknas trningsdatans medelvrden
+*                          och standardavvikelser i ett parallellt pass innan trningen, varefter
+*                          trning sker p standardiserade in- och utsignaler. Detta mjliggr
+*                          betydligt hgre lrhastigheter fr insignaler med stort belopp, dr
+*                          lrhastigheten annars mste vara mycket lg fr att undvika divergens.
+*                          Skalningen vvs tillbaka in i modellens parametrar efter trningen,
+*                          s prediktion sker precis som tidigare. Skalningen sparas tills
+*                          trningsdatan ndras via lin_reg_set_training_data eller inlsning,
+*                          s upprepade anrop av lin_reg_train rknar inte om den. Asynkron
+*                          trning via lin_reg_train_hogwild pverkas inte.
+*
+*                          - self       : Pekare till regressionsmodellen.
+*                          - standardize: Indikerar ifall standardisering skall anvndas.
+**************************************************************************************************/
+void lin_reg_set_standardize(struct lin_reg* self,
+                             const bool standardize)
+{
+   self->standardize = standardize;
+   return;
+}
+
 /**************************************************************************************************
 * lin_reg_load_training_data: Lser in trningsdata till angiven regressionsmodell frn en fil
-*                             via angiven filskvg.
+*                             via angiven filskvg. Filen tolkas parallellt av lika mnga
+*                             trdar som det finns tillgngliga processorkrnor.
 * 
 *                             - self    : Pekare till regressionsmodellen.
 *                             - filepath: Pekare till filskvgen.
@@ -88,22 +322,33 @@ void lin_reg_ptr_delete(struct lin_reg** self)
 void lin_reg_load_training_data(struct lin_reg* self, 
                                 const char* filepath)
 {
-   FILE* fstream = fopen(filepath, "r");
-
-   if (!fstream)
-   {
-      fprintf(stderr, "Could not open file at path %s!\n\n", filepath);
-   }
-   else
-   {
-      char s[100] = { '\0' };
-      while (fgets(s, (int)sizeof(s), fstream))
-      {
-         lin_reg_extract(self, s);
-      }
-      fclose(fstream);
-   }
+   lin_reg_load_training_data_parallel(self, filepath, 0);
+   return;
+}
 
+/**************************************************************************************************
+* lin_reg_load_training_data_parallel: Lser in trningsdata till angiven regressionsmodell frn
+*                                      en fil via angiven filskvg. Filen delas upp i lika stora
+*                                      stycken som tolkas av var sin trd till separata
+*                                      buffertar. Buffertarna sls sedan samman i filordning,
+*                                      dr respektive buffert placeras p en position given av
+*                                      summan av antalet rader i fregende buffertar. Filer
+*                                      komprimerade med gzip eller zstd identifieras automatiskt
+*                                      och lses d in strmmande via lin_reg_load_compressed.
+*
+*                                      - self       : Pekare till regressionsmodellen.
+*                                      - filepath   : Pekare till filskvgen.
+*                                      - num_threads: Antalet trdar (0 = antalet processorkrnor).
+*                                                     Antalet begrnsas fr sm filer s att
+*                                                     varje trd tolkar ett stycke av rimlig storlek.
+**************************************************************************************************/
+void lin_reg_load_training_data_parallel(struct lin_reg* self,
+                                         const char* filepath,
+                                         size_t num_threads)
+{
+   if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_LOAD);
+   lin_reg_load_file(self, filepath, num_threads);
+   if (self->perf) perf_counters_end(self->perf, PERF_PHASE_LOAD);
    return;
 }
 
@@ -135,6 +380,7 @@ void lin_reg_set_training_data(struct lin_reg* self,
       self->train_order.data[offset + i] = offset + i;
    }
 
+   self->scale_cached = false;
    return;
 }
 
@@ -142,7 +388,10 @@ void lin_reg_set_training_data(struct lin_reg* self,
 * lin_reg_train: Trnar angiven regressionsmodell med givet antal epoker samt given lrhastighet. 
 *                I brjan av varje epok randomiseras ordningsfljden p trningsuppsttningarna 
 *                fr att undvika att eventuella mnster som frekommer i trningsdatan skall 
-*                pverka trningen.
+*                pverka trningen. Ifall pipelinad randomisering r aktiverad tas nsta epoks
+*                ordningsfljd fram parallellt med aktuell epok via lin_reg_train_pipelined.
+*                Ifall standardisering r aktiverad sker trningen i standardiserad rymd via
+*                lin_reg_train_standardized.
 * 
 *                - self         : Pekare till regressionsmodellen.
 *                - num_epochs   : Antalet epoker som skall genomfras vid trning.
@@ -153,18 +402,284 @@ void lin_reg_train(struct lin_reg* self,
                    const size_t num_epochs,
                    const double learning_rate)
 {
+   if (self->standardize && !self->scale && self->train_in.size > 1)
+   {
+      lin_reg_train_standardized(self, num_epochs, learning_rate, false);
+      return;
+   }
+
+   if (self->pipelined_shuffle && num_epochs > 1)
+   {
+      lin_reg_train_pipelined(self, num_epochs, learning_rate);
+      return;
+   }
+
    for (size_t i = 0; i < num_epochs; ++i)
    {
-      lin_reg_shuffle(self);
+      if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_SHUFFLE);
+      lin_reg_shuffle(self->train_order.data, self->train_order.size, &self->rng_state);
+      if (self->perf) perf_counters_end(self->perf, PERF_PHASE_SHUFFLE);
+      lin_reg_train_epoch(self, learning_rate, self->train_order.size);
+      self->epoch++;
+      lin_reg_checkpoint(self, self->rng_state);
+   }
+
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_resume: terupptar trning av angiven regressionsmodell frn angiven kontrollpunkt.
+*                 Modellens parametrar, antalet genomfrda epoker, slumpgeneratorns tillstnd
+*                 samt ordningsfljden terstlls, varefter trningen fortstter tills angivet
+*                 totalt antal epoker har genomfrts. Givet samma trningsdata och lrhastighet
+*                 blir resultatet bitidentiskt med en oavbruten trning. Trningsdata mste
+*                 drmed ha tillfrts innan anropet. Kontrollpunkter tagna under standardiserad
+*                 trning innehller parametrar i standardiserad rymd, s standardisering
+*                 aktiveras eller inaktiveras enligt kontrollpunkten och trningen fortstter i
+*                 samma rymd. Bitidentiteten frutstter att den oavbrutna trningen skedde via
+*                 ett enda anrop av lin_reg_train. Returnerar 0 vid lyckad terupptagning,
+*                 annars 1.
+*
+*                 - self         : Pekare till regressionsmodellen.
+*                 - filepath     : Filskvg till kontrollpunktsfilen.
+*                 - num_epochs   : Totalt antal epoker, inklusive redan genomfrda epoker.
+*                 - learning_rate: Den lrhastighet som skall anvndas vid trning fr att
+*                                  justera modellens parametrar vid avvikelse.
+**************************************************************************************************/
+int lin_reg_resume(struct lin_reg* self,
+                   const char* filepath,
+                   const size_t num_epochs,
+                   const double learning_rate)
+{
+   struct checkpoint_state state;
+   uint_vector_new(&state.order);
+
+   if (checkpoint_read(filepath, &state) || state.order.size != self->train_order.size ||
+       (state.standardized && self->train_in.size < 2))
+   {
+      fprintf(stderr, "Could not resume training from checkpoint at path %s!\n\n", filepath);
+      uint_vector_delete(&state.order);
+      return 1;
+   }
+
+   uint_vector_delete(&self->train_order);
+   self->train_order = state.order;
+   self->weight = state.weight;
+   self->bias = state.bias;
+   self->epoch = state.epoch;
+   self->rng_state = state.rng_state;
+   self->standardize = state.standardized;
+
+   if (state.standardized)
+   {
+      lin_reg_train_standardized(self, self->epoch < num_epochs ? num_epochs - self->epoch : 0,
+                                 learning_rate, true);
+   }
+   else if (self->epoch < num_epochs)
+   {
+      lin_reg_train(self, num_epochs - self->epoch, learning_rate);
+   }
+
+   return 0;
+}
+
+/**************************************************************************************************
+* lin_reg_train_hogwild: Trnar angiven regressionsmodell asynkront med angivet antal trdar
+*                        (s kallad Hogwild-trning). Hela ordningsfljden randomiseras frst och
+*                        delas sedan upp i lika stora delar, s att varje del utgr ett
+*                        slumpmssigt urval ven nr trningsdatan r sorterad, exempelvis efter
+*                        insignal. Varje trd randomiserar sedan samt trnar p sin egen del under
+*                        samtliga epoker. Trdarna justerar gemensamma parametrar samtidigt utan
+*                        ls: parametrarna lses och skrivs med relaxerade atomiska operationer,
+*                        vilket kompileras till vanliga lsningar och skrivningar. En justering
+*                        kan drmed skrivas ver av en annan trd, men frlusten r frsumbar
+*                        eftersom varje justering r liten, medan compare-and-swap frdubblade
+*                        tidstgngen redan med en trd. Trdarna synkroniseras inte mellan
+*                        epokerna, vilket gr att resultatet inte r deterministiskt, men
+*                        skillnaden mot sekventiell trning r frsumbar fr konvexa problem
+*                        ssom linjr regression.
+*                        Av samma anledning tas inga kontrollpunkter under asynkron trning.
+*
+*                        - self         : Pekare till regressionsmodellen.
+*                        - num_epochs   : Antalet epoker som skall genomfras vid trning.
+*                        - learning_rate: Den lrhastighet som skall anvndas vid trning fr
+*                                         att justera modellens parametrar vid avvikelse.
+*                        - num_threads  : Antalet trdar (0 = antalet processorkrnor).
+**************************************************************************************************/
+void lin_reg_train_hogwild(struct lin_reg* self,
+                           const size_t num_epochs,
+                           const double learning_rate,
+                           size_t num_threads)
+{
+   if (!num_threads) num_threads = lin_reg_num_cpus();
+   if (num_threads > self->train_order.size) num_threads = self->train_order.size;
+   if (!num_threads) return;
+
+   struct lin_reg_hogwild_task* tasks = (struct lin_reg_hogwild_task*)MEM_MALLOC(MEM_SUBSYSTEM_TRAINING, sizeof(struct lin_reg_hogwild_task) * num_threads);
+   pthread_t* threads = (pthread_t*)MEM_MALLOC(MEM_SUBSYSTEM_TRAINING, sizeof(pthread_t) * num_threads);
+   bool* started = (bool*)MEM_MALLOC(MEM_SUBSYSTEM_TRAINING, sizeof(bool) * num_threads);
+   _Atomic double weight;
+   _Atomic double bias;
+
+   if (!tasks || !threads || !started)
+   {
+      MEM_FREE(MEM_SUBSYSTEM_TRAINING, tasks);
+      MEM_FREE(MEM_SUBSYSTEM_TRAINING, threads);
+      MEM_FREE(MEM_SUBSYSTEM_TRAINING, started);
+      lin_reg_train(self, num_epochs, learning_rate);
+      return;
+   }
+
+   atomic_init(&weight, self->weight);
+   atomic_init(&bias, self->bias);
+   if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_SHUFFLE);
+   lin_reg_shuffle(self->train_order.data, self->train_order.size, &self->rng_state);
+   if (self->perf) perf_counters_end(self->perf, PERF_PHASE_SHUFFLE);
+   if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_UPDATE);
+
+   for (size_t i = 0; i < num_threads; ++i)
+   {
+      const size_t begin = self->train_order.size / num_threads * i;
+      const size_t end = i + 1 < num_threads ? self->train_order.size / num_threads * (i + 1) : self->train_order.size;
+      tasks[i].model = self;
+      tasks[i].weight = &weight;
+      tasks[i].bias = &bias;
+      tasks[i].order = self->train_order.data + begin;
+      tasks[i].size = end - begin;
+      tasks[i].num_epochs = num_epochs;
+      tasks[i].learning_rate = learning_rate;
+      tasks[i].rng_state = lin_reg_random(&self->rng_state);
+   }
+
+   for (size_t i = 1; i < num_threads; ++i)
+   {
+      started[i] = !pthread_create(&threads[i], 0, &lin_reg_train_hogwild_thread, &tasks[i]);
+   }
+
+   lin_reg_train_hogwild_thread(&tasks[0]);
+
+   for (size_t i = 1; i < num_threads; ++i)
+   {
+      if (started[i]) pthread_join(threads[i], 0);
+      else lin_reg_train_hogwild_thread(&tasks[i]);
+   }
 
-      for (size_t j = 0; j < self->train_order.size; ++j)
+   if (self->perf) perf_counters_end(self->perf, PERF_PHASE_UPDATE);
+   self->weight = atomic_load(&weight);
+   self->bias = atomic_load(&bias);
+   self->epoch += num_epochs;
+   MEM_FREE(MEM_SUBSYSTEM_TRAINING, tasks);
+   MEM_FREE(MEM_SUBSYSTEM_TRAINING, threads);
+   MEM_FREE(MEM_SUBSYSTEM_TRAINING, started);
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_train_progressive: Trnar angiven regressionsmodell p slumpmssiga delmngder av
+*                            trningsdatan, vars storlek dubbleras i varje steg. Ordningsfljden
+*                            randomiseras en gng i brjan, varefter brjan av ordningsfljden
+*                            utgr en slumpmssig delmngd av nskad storlek utan att ngon
+*                            trningsdata kopieras. Varje steg trnas med angivet antal epoker,
+*                            dr endast delmngden randomiseras infr varje epok, s att varje
+*                            delmngd innehller fregende. Efter varje steg utvrderas bde
+*                            fregende och aktuella parametrar p de trningsuppsttningar som
+*                            nsta steg lgger till, vilka modellen nnu inte har trnats p.
+*                            Frbttringen av medelkvadratfelet rknas som verklig endast ifall
+*                            den verstiger tv standardfel fr den parvisa skillnaden samt
+*                            angiven relativ tolerans, s att slumpmssiga variationer i
+*                            parametrarna inte tolkas som konvergens eller fortsatt frbttring.
+*                            Delmngden slutar vxa efter tv steg i rad utan verklig frbttring,
+*                            alternativt nr hela trningsdatan anvnds. Utvrderingen krver
+*                            minst LIN_REG_PROGRESSIVE_MIN_HOLDOUT uppsttningar fr att vara
+*                            avgrande, annars fortstter delmngden att vxa, och frsta steget
+*                            omfattar minst LIN_REG_PROGRESSIVE_MIN_SIZE uppsttningar s att
+*                            trningen aldrig avslutas p ett ftal uppsttningar.
+*                            Fr enkla linjra samband ger detta nra samma noggrannhet som
+*                            trning p samtliga trningsuppsttningar, men med en brkdel av
+*                            antalet genomlsningar av trningsdatan. Standardisering samt
+*                            kontrollpunkter anvnds inte i detta lge. Storleken p den
+*                            slutliga delmngden returneras.
+*
+*                            - self            : Pekare till regressionsmodellen.
+*                            - learning_rate   : Den lrhastighet som skall anvndas vid trning.
+*                            - initial_size    : Delmngdens storlek i frsta steget (minst
+*                                                LIN_REG_PROGRESSIVE_MIN_SIZE).
+*                            - epochs_per_stage: Antalet epoker per steg.
+*                            - tolerance       : Minsta relativa frbttring av medelkvadratfelet
+*                                                mellan tv steg, exempelvis 0.001 fr 0.1 %.
+**************************************************************************************************/
+size_t lin_reg_train_progressive(struct lin_reg* self,
+                                 const double learning_rate,
+                                 const size_t initial_size,
+                                 const size_t epochs_per_stage,
+                                 const double tolerance)
+{
+   const size_t size = self->train_order.size;
+   size_t num_sets = initial_size > LIN_REG_PROGRESSIVE_MIN_SIZE ?
+      initial_size : LIN_REG_PROGRESSIVE_MIN_SIZE;
+   size_t stable_stages = 0;
+   if (!size) return 0;
+
+   if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_SHUFFLE);
+   lin_reg_shuffle(self->train_order.data, size, &self->rng_state);
+   if (self->perf) perf_counters_end(self->perf, PERF_PHASE_SHUFFLE);
+
+   while (true)
+   {
+      const double previous_weight = self->weight;
+      const double previous_bias = self->bias;
+      if (num_sets > size) num_sets = size;
+
+      for (size_t i = 0; i < epochs_per_stage; ++i)
       {
-         const size_t k = self->train_order.data[j];
-         lin_reg_optimize(self, self->train_in.data[k], self->train_out.data[k], learning_rate);
+         if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_SHUFFLE);
+         lin_reg_shuffle(self->train_order.data, num_sets, &self->rng_state);
+         if (self->perf) perf_counters_end(self->perf, PERF_PHASE_SHUFFLE);
+         lin_reg_train_epoch(self, learning_rate, num_sets);
+         self->epoch++;
+      }
+
+      if (num_sets == size) break;
+      const size_t next_sets = num_sets > size / 2 ? size : num_sets * 2;
+
+      if (next_sets - num_sets < LIN_REG_PROGRESSIVE_MIN_HOLDOUT)
+      {
+         stable_stages = 0;
+      }
+      else if (lin_reg_stage_improved(self, previous_weight, previous_bias, num_sets, next_sets, tolerance))
+      {
+         stable_stages = 0;
       }
+      else if (++stable_stages >= LIN_REG_PROGRESSIVE_PATIENCE)
+      {
+         break;
+      }
+
+      num_sets = next_sets;
    }
 
-   return;
+   return num_sets;
+}
+
+/**************************************************************************************************
+* lin_reg_mean_squared_error: Returnerar medelkvadratfelet fr angiven regressionsmodell ver
+*                             samtliga trningsuppsttningar, vilket kan anvndas fr att
+*                             jmfra hur vl olika trningsmetoder har konvergerat.
+*
+*                             - self: Pekare till regressionsmodellen.
+**************************************************************************************************/
+double lin_reg_mean_squared_error(const struct lin_reg* self)
+{
+   double sum = 0;
+   if (!self->train_in.size) return 0;
+
+   for (size_t i = 0; i < self->train_in.size; ++i)
+   {
+      const double error = self->train_out.data[i] - (self->weight * self->train_in.data[i] + self->bias);
+      sum += error * error;
+   }
+
+   return sum / self->train_in.size;
 }
 
 /**************************************************************************************************
@@ -200,6 +715,7 @@ void lin_reg_predict_all(const struct lin_reg* self,
    if (!self->train_in.size) return;
 
    const size_t last = self->train_in.size - 1;
+   if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_PREDICT);
    fprintf(ostream, "--------------------------------------------------------------------------\n");
 
    for (size_t i = 0; i < self->train_in.size; ++i)
@@ -220,6 +736,7 @@ void lin_reg_predict_all(const struct lin_reg* self,
    }
 
    fprintf(ostream, "--------------------------------------------------------------------------\n\n");
+   if (self->perf) perf_counters_end(self->perf, PERF_PHASE_PREDICT);
    return;
 }
 
@@ -246,6 +763,7 @@ void lin_reg_predict_range(const struct lin_reg* self,
 {
    if (!self->train_in.size) return;
    if (!ostream) ostream = stdout;
+   if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_PREDICT);
    fprintf(ostream, "--------------------------------------------------------------------------\n");
 
    for (double i = start_val; i <= end_val; i += step)
@@ -266,27 +784,474 @@ void lin_reg_predict_range(const struct lin_reg* self,
    }
 
    fprintf(ostream, "--------------------------------------------------------------------------\n\n");
+   if (self->perf) perf_counters_end(self->perf, PERF_PHASE_PREDICT);
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_score_file: Predikterar samtliga insignaler i angiven infil och skriver prediktionerna
+*                     till angiven utfil, en per inrad i samma ordning och format, dr rader
+*                     som saknar ett tal ger utsignalen nan. Filerna
+*                     strmmas genom en pipeline dr lsning, tolkning, prediktion och
+*                     formatering sker i var sin trd, s att minnestgngen r konstant och
+*                     ingen trningsdata behver lsas in. Returnerar 0 vid lyckad prediktion,
+*                     annars 1.
+*
+*                     - self       : Pekare till regressionsmodellen.
+*                     - input_path : Filskvg till infilen.
+*                     - output_path: Filskvg till utfilen.
+*                     - format     : Filformat fr in- och utfilen (text eller binrt).
+*                     - stats      : Pekare till strukt dr antalet rader, tidstgng samt
+*                                    genomstrmning lagras (null = ignoreras).
+**************************************************************************************************/
+int lin_reg_score_file(const struct lin_reg* self,
+                       const char* input_path,
+                       const char* output_path,
+                       const enum score_pipeline_format format,
+                       struct score_pipeline_stats* stats)
+{
+   if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_PREDICT);
+   const int error = score_pipeline_run(self->weight, self->bias, input_path, output_path, format, stats);
+   if (self->perf) perf_counters_end(self->perf, PERF_PHASE_PREDICT);
+   return error;
+}
+
+/**************************************************************************************************
+* lin_reg_train_epoch: Genomfr en epok, dr modellens parametrar justeras fr angivet antal
+*                      trningsuppsttningar frn brjan av aktuell ordningsfljd. Under
+*                      standardiserad trning standardiseras respektive in- och utsignal innan
+*                      justeringen.
+*
+*                      - self         : Pekare till regressionsmodellen.
+*                      - learning_rate: Den lrhastighet som skall anvndas vid trning fr att
+*                                       justera modellens parametrar vid avvikelse.
+*                      - num_sets     : Antalet trningsuppsttningar som skall anvndas.
+**************************************************************************************************/
+static void lin_reg_train_epoch(struct lin_reg* self,
+                                const double learning_rate,
+                                const size_t num_sets)
+{
+   if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_UPDATE);
+
+   if (self->scale)
+   {
+      const double mean_in = self->scale->mean_in;
+      const double mean_out = self->scale->mean_out;
+      const double inv_std_in = 1.0 / self->scale->std_in;
+      const double inv_std_out = 1.0 / self->scale->std_out;
+
+      for (size_t j = 0; j < num_sets; ++j)
+      {
+         const size_t k = self->train_order.data[j];
+         lin_reg_optimize(self, (self->train_in.data[k] - mean_in) * inv_std_in,
+                          (self->train_out.data[k] - mean_out) * inv_std_out, learning_rate);
+      }
+   }
+   else
+   {
+      for (size_t j = 0; j < num_sets; ++j)
+      {
+         const size_t k = self->train_order.data[j];
+         lin_reg_optimize(self, self->train_in.data[k], self->train_out.data[k], learning_rate);
+      }
+   }
+
+   if (self->perf) perf_counters_end(self->perf, PERF_PHASE_UPDATE);
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_train_pipelined: Trnar angiven regressionsmodell dr nsta epoks ordningsfljd tas
+*                          fram av en hjlptrd i ett separat indexflt medan aktuell epok trnas.
+*                          Flten byts vid varje epokgrns, s randomiseringen dljs helt bakom
+*                          trningen s lnge den inte tar lngre tid n en epok. Eftersom
+*                          hjlptrden randomiserar en kopia av aktuell ordningsfljd med samma
+*                          slumpgenerator blir resultatet identiskt med ordinarie trning. Vid
+*                          mtning med hrdvarurknare mts den tid som huvudtrden vntar p
+*                          hjlptrden som randomisering. Hjlptrdens rknarvrden adderas
+*                          dremot frst nr trden avslutas, vanligen under
+*                          parameterjusteringen, s rknarvrdena per fas r inte tillfrlitliga
+*                          i detta lge (se lin_reg_set_perf_counters). Kontrollpunkter tas med
+*                          slumpgeneratorns tillstnd frn innan hjlptrden startades, vilket
+*                          motsvarar tillstndet vid ordinarie trning. Utan trningsdata, eller
+*                          ifall minnet fr det separata indexfltet inte rcker, anvnds
+*                          ordinarie trning.
+*
+*                          - self         : Pekare till regressionsmodellen.
+*                          - num_epochs   : Antalet epoker som skall genomfras vid trning.
+*                          - learning_rate: Den lrhastighet som skall anvndas vid trning fr
+*                                           att justera modellens parametrar vid avvikelse.
+**************************************************************************************************/
+static void lin_reg_train_pipelined(struct lin_reg* self,
+                                    const size_t num_epochs,
+                                    const double learning_rate)
+{
+   struct uint_vector next;
+   uint_vector_new(&next);
+
+   if (!self->train_order.size || uint_vector_resize(&next, self->train_order.size))
+   {
+      self->pipelined_shuffle = false;
+      lin_reg_train(self, num_epochs, learning_rate);
+      self->pipelined_shuffle = true;
+      return;
+   }
+
+   if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_SHUFFLE);
+   lin_reg_shuffle(self->train_order.data, self->train_order.size, &self->rng_state);
+   if (self->perf) perf_counters_end(self->perf, PERF_PHASE_SHUFFLE);
+
+   for (size_t i = 0; i < num_epochs; ++i)
+   {
+      const uint64_t rng_state = self->rng_state;
+      struct lin_reg_shuffle_task task = { .source = self->train_order.data,
+                                           .destination = next.data,
+                                           .size = self->train_order.size,
+                                           .rng_state = &self->rng_state };
+      pthread_t thread;
+      const bool last_epoch = i + 1 == num_epochs;
+      const bool started = !last_epoch && !pthread_create(&thread, 0, &lin_reg_shuffle_next, &task);
+
+      lin_reg_train_epoch(self, learning_rate, self->train_order.size);
+      self->epoch++;
+      lin_reg_checkpoint(self, rng_state);
+      if (last_epoch) break;
+
+      if (self->perf) perf_counters_begin(self->perf, PERF_PHASE_SHUFFLE);
+      if (started) pthread_join(thread, 0);
+      else lin_reg_shuffle_next(&task);
+      if (self->perf) perf_counters_end(self->perf, PERF_PHASE_SHUFFLE);
+
+      const struct uint_vector current = self->train_order;
+      self->train_order = next;
+      next = current;
+   }
+
+   uint_vector_delete(&next);
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_train_hogwild_thread: Trdfunktion som genomfr asynkron trning p trdens del av
+*                               ordningsfljden. Returnerar alltid null.
+*
+*                               - arg: Pekare till trdens uppdrag (struct lin_reg_hogwild_task).
+**************************************************************************************************/
+static void* lin_reg_train_hogwild_thread(void* arg)
+{
+   struct lin_reg_hogwild_task* task = (struct lin_reg_hogwild_task*)arg;
+   const double* train_in = task->model->train_in.data;
+   const double* train_out = task->model->train_out.data;
+
+   for (size_t i = 0; i < task->num_epochs; ++i)
+   {
+      lin_reg_shuffle(task->order, task->size, &task->rng_state);
+
+      for (size_t j = 0; j < task->size; ++j)
+      {
+         const size_t k = task->order[j];
+         const double weight = atomic_load_explicit(task->weight, memory_order_relaxed);
+         const double bias = atomic_load_explicit(task->bias, memory_order_relaxed);
+         const double error = train_out[k] - (weight * train_in[k] + bias);
+         const double change_rate = error * task->learning_rate;
+         atomic_store_explicit(task->bias, bias + change_rate, memory_order_relaxed);
+         atomic_store_explicit(task->weight, weight + change_rate * train_in[k], memory_order_relaxed);
+      }
+   }
+
+   return 0;
+}
+
+/**************************************************************************************************
+* lin_reg_stage_improved: Indikerar ifall aktuella parametrar ger ett verkligt lgre
+*                         medelkvadratfel n fregende parametrar p trningsuppsttningarna i
+*                         angivet intervall av ordningsfljden. Skillnaden i kvadratfel berknas
+*                         parvis per trningsuppsttning, vilket tar bort variationen mellan
+*                         uppsttningarna. Frbttringen mste verstiga LIN_REG_PROGRESSIVE_Z
+*                         standardfel fr att inte kunna frklaras av slumpen, samt angiven
+*                         relativ tolerans fr att vara av praktisk betydelse. Frre n tv
+*                         uppsttningar kan inte avgra saken och rknas drfr som frbttring,
+*                         s att delmngden fortstter att vxa.
+*
+*                         - self           : Pekare till regressionsmodellen.
+*                         - previous_weight: Fregende lutning.
+*                         - previous_bias  : Fregende vilovrde.
+*                         - begin          : Frsta index i ordningsfljden som utvrderas.
+*                         - end            : Index efter det sista som utvrderas.
+*                         - tolerance      : Minsta relativa frbttring av medelkvadratfelet.
+**************************************************************************************************/
+static bool lin_reg_stage_improved(const struct lin_reg* self,
+                                   const double previous_weight,
+                                   const double previous_bias,
+                                   const size_t begin,
+                                   const size_t end,
+                                   const double tolerance)
+{
+   const size_t num_sets = end - begin;
+   double sum = 0, sum_squared = 0, current_sum = 0;
+   if (num_sets < 2) return true;
+
+   for (size_t i = begin; i < end; ++i)
+   {
+      const size_t k = self->train_order.data[i];
+      const double previous_error = self->train_out.data[k] -
+         (previous_weight * self->train_in.data[k] + previous_bias);
+      const double current_error = self->train_out.data[k] -
+         (self->weight * self->train_in.data[k] + self->bias);
+      const double difference = previous_error * previous_error - current_error * current_error;
+      sum += difference;
+      sum_squared += difference * difference;
+      current_sum += current_error * current_error;
+   }
+
+   const double mean = sum / num_sets;
+   const double variance = (sum_squared - sum * mean) / (num_sets - 1);
+   const double standard_error = variance > 0 ? sqrt(variance / num_sets) : 0;
+   return mean > LIN_REG_PROGRESSIVE_Z * standard_error && mean > tolerance * current_sum / num_sets;
+}
+
+/**************************************************************************************************
+* lin_reg_checkpoint: Tar en kontrollpunkt efter avslutad epok ifall kontrollpunkter r aktiverade
+*                     och angivet intervall har passerats. Tillstndet kopieras och skrivs sedan
+*                     till fil i en separat trd, s att trningen kan fortstta direkt.
+*
+*                     - self     : Pekare till regressionsmodellen.
+*                     - rng_state: Slumpgeneratorns tillstnd infr nsta epoks randomisering.
+**************************************************************************************************/
+static void lin_reg_checkpoint(struct lin_reg* self,
+                               const uint64_t rng_state)
+{
+   if (!self->checkpoint || !checkpoint_due(self->checkpoint, self->epoch)) return;
+   checkpoint_save_async(self->checkpoint, self->weight, self->bias, self->scale != 0,
+                         self->epoch, rng_state, &self->train_order);
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_train_standardized: Trnar angiven regressionsmodell i standardiserad rymd. Trningsdatans
+*                             skalning berknas frst, alternativt hmtas frn fregende
+*                             berkning ifall trningsdatan inte har ndrats, varefter modellens
+*                             parametrar rknas om till standardiserad rymd och trning sker som
+*                             vanligt p standardiserade signaler. Slutligen vvs skalningen
+*                             tillbaka in i parametrarna. Kontrollpunkter lagrar parametrarna i
+*                             standardiserad rymd, s att terupptagen trning kan fortstta
+*                             bitidentiskt utan att parametrarna rknas om.
+*
+*                             - self         : Pekare till regressionsmodellen.
+*                             - num_epochs   : Antalet epoker som skall genomfras vid trning.
+*                             - learning_rate: Den lrhastighet som skall anvndas vid trning fr
+*                                              att justera modellens parametrar vid avvikelse.
+*                             - normalized   : Indikerar ifall modellens parametrar redan r i
+*                                              standardiserad rymd (vid terupptagen trning).
+**************************************************************************************************/
+static void lin_reg_train_standardized(struct lin_reg* self,
+                                       const size_t num_epochs,
+                                       const double learning_rate,
+                                       const bool normalized)
+{
+   const struct lin_reg_scale* scale = &self->scale_cache;
+
+   if (!self->scale_cached)
+   {
+      lin_reg_scale_compute(self, &self->scale_cache);
+      self->scale_cached = true;
+   }
+
+   if (!normalized)
+   {
+      const double weight = self->weight;
+      self->weight = weight * scale->std_in / scale->std_out;
+      self->bias = (self->bias + weight * scale->mean_in - scale->mean_out) / scale->std_out;
+   }
+
+   self->scale = scale;
+   lin_reg_train(self, num_epochs, learning_rate);
+   self->scale = 0;
+   lin_reg_scale_fold(scale, self->weight, self->bias, &self->weight, &self->bias);
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_scale_compute: Berknar medelvrden samt standardavvikelser fr angiven modells
+*                        trningsdata i ett enda pass. Trningsdatan delas upp i ett fast antal
+*                        delar, som berknas parallellt via Welfords algoritm och sedan sls samman
+*                        i ordning via Chans formel. Eftersom uppdelningen r oberoende av antalet
+*                        trdar blir resultatet identiskt oavsett antalet processorkrnor.
+*                        Standardavvikelser lika med noll erstts med ett fr att undvika division
+*                        med noll.
+*
+*                        - self : Pekare till regressionsmodellen.
+*                        - scale: Pekare till strukten dr berknad skalning lagras.
+**************************************************************************************************/
+static void lin_reg_scale_compute(const struct lin_reg* self,
+                                  struct lin_reg_scale* scale)
+{
+   struct lin_reg_moments parts[LIN_REG_SCALE_PARTS];
+   struct lin_reg_moments_task tasks[LIN_REG_SCALE_PARTS];
+   pthread_t threads[LIN_REG_SCALE_PARTS];
+   bool started[LIN_REG_SCALE_PARTS] = { false };
+   struct lin_reg_moments total = { 0, 0, 0, 0, 0 };
+   size_t num_threads = lin_reg_num_cpus();
+   if (num_threads > LIN_REG_SCALE_PARTS) num_threads = LIN_REG_SCALE_PARTS;
+
+   for (size_t i = 0; i < num_threads; ++i)
+   {
+      tasks[i].model = self;
+      tasks[i].parts = parts;
+      tasks[i].first = i;
+      tasks[i].num_threads = num_threads;
+   }
+
+   for (size_t i = 1; i < num_threads; ++i)
+   {
+      started[i] = !pthread_create(&threads[i], 0, &lin_reg_moments_compute, &tasks[i]);
+   }
+
+   lin_reg_moments_compute(&tasks[0]);
+
+   for (size_t i = 1; i < num_threads; ++i)
+   {
+      if (started[i]) pthread_join(threads[i], 0);
+      else lin_reg_moments_compute(&tasks[i]);
+   }
+
+   for (size_t i = 0; i < LIN_REG_SCALE_PARTS; ++i)
+   {
+      const struct lin_reg_moments* part = &parts[i];
+      const size_t count = total.count + part->count;
+      if (!part->count) continue;
+
+      const double delta_in = part->mean_in - total.mean_in;
+      const double delta_out = part->mean_out - total.mean_out;
+      const double weight = (double)part->count / count;
+      total.m2_in += part->m2_in + delta_in * delta_in * total.count * weight;
+      total.m2_out += part->m2_out + delta_out * delta_out * total.count * weight;
+      total.mean_in += delta_in * weight;
+      total.mean_out += delta_out * weight;
+      total.count = count;
+   }
+
+   scale->mean_in = total.mean_in;
+   scale->mean_out = total.mean_out;
+   scale->std_in = total.count ? sqrt(total.m2_in / total.count) : 0;
+   scale->std_out = total.count ? sqrt(total.m2_out / total.count) : 0;
+   if (scale->std_in == 0) scale->std_in = 1;
+   if (scale->std_out == 0) scale->std_out = 1;
    return;
 }
 
 /**************************************************************************************************
-* lin_reg_shuffle: Randomiserar den inbrdes ordningsfljden fr angiven regressionsmodells 
-*                  trningsuppsttningar.
+* lin_reg_moments_compute: Trdfunktion som berknar antal, medelvrden samt summan av kvadratiska
+*                          avvikelser fr trdens delar av trningsdatan via Welfords algoritm.
+*                          Returnerar alltid null.
+*
+*                          - arg: Pekare till trdens uppdrag (struct lin_reg_moments_task).
+**************************************************************************************************/
+static void* lin_reg_moments_compute(void* arg)
+{
+   const struct lin_reg_moments_task* task = (const struct lin_reg_moments_task*)arg;
+   const size_t size = task->model->train_in.size;
+
+   for (size_t i = task->first; i < LIN_REG_SCALE_PARTS; i += task->num_threads)
+   {
+      struct lin_reg_moments* part = &task->parts[i];
+      const size_t begin = size / LIN_REG_SCALE_PARTS * i;
+      const size_t end = i + 1 < LIN_REG_SCALE_PARTS ? size / LIN_REG_SCALE_PARTS * (i + 1) : size;
+      part->count = 0;
+      part->mean_in = part->m2_in = 0;
+      part->mean_out = part->m2_out = 0;
+
+      for (size_t j = begin; j < end; ++j)
+      {
+         const double x = task->model->train_in.data[j];
+         const double y = task->model->train_out.data[j];
+         const double delta_in = x - part->mean_in;
+         const double delta_out = y - part->mean_out;
+         part->count++;
+         part->mean_in += delta_in / part->count;
+         part->mean_out += delta_out / part->count;
+         part->m2_in += delta_in * (x - part->mean_in);
+         part->m2_out += delta_out * (y - part->mean_out);
+      }
+   }
+
+   return 0;
+}
+
+/**************************************************************************************************
+* lin_reg_scale_fold: Rknar om parametrar frn standardiserad rymd till originalrymden, s att
+*                     prediktion kan ske direkt p ostandardiserade insignaler. Fr standardiserade
+*                     signaler gller y' = w'x' + b', dr x' = (x - mx) / sx och y' = (y - my) / sy,
+*                     vilket ger w = w' * sy / sx samt b = my + sy * b' - w * mx.
+*
+*                     - scale        : Pekare till skalningen.
+*                     - weight       : Lutning i standardiserad rymd.
+*                     - bias         : Vilovrde i standardiserad rymd.
+*                     - folded_weight: Pekare till variabel dr lutningen i originalrymden lagras.
+*                     - folded_bias  : Pekare till variabel dr vilovrdet i originalrymden lagras.
+**************************************************************************************************/
+static void lin_reg_scale_fold(const struct lin_reg_scale* scale,
+                               const double weight,
+                               const double bias,
+                               double* folded_weight,
+                               double* folded_bias)
+{
+   const double new_weight = weight * scale->std_out / scale->std_in;
+   *folded_bias = scale->mean_out + scale->std_out * bias - new_weight * scale->mean_in;
+   *folded_weight = new_weight;
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_shuffle: Randomiserar den inbrdes ordningsfljden fr angivna trningsuppsttningar.
 * 
-*                  - self: Pekare till regressionsmodellen.
+*                  - order    : Pekare till flt innehllande trningsuppsttningarnas index.
+*                  - size     : Antalet trningsuppsttningar.
+*                  - rng_state: Pekare till slumpgeneratorns tillstnd.
 **************************************************************************************************/
-static void lin_reg_shuffle(struct lin_reg* self)
+static void lin_reg_shuffle(size_t* order,
+                            const size_t size,
+                            uint64_t* rng_state)
 {
-   for (size_t i = 0; i < self->train_order.size; ++i)
+   for (size_t i = 0; i < size; ++i)
    {
-      const size_t r = (size_t)rand() % self->train_order.size;
-      const size_t temp = self->train_order.data[i];
-      self->train_order.data[i] = self->train_order.data[r];
-      self->train_order.data[r] = temp;
+      const size_t r = (size_t)(lin_reg_random(rng_state) % size);
+      const size_t temp = order[i];
+      order[i] = order[r];
+      order[r] = temp;
    }
    return;
 }
 
+/**************************************************************************************************
+* lin_reg_shuffle_next: Trdfunktion som kopierar aktuell ordningsfljd och randomiserar kopian,
+*                       vilket ger nsta epoks ordningsfljd. Returnerar alltid null.
+*
+*                       - arg: Pekare till randomiseringsuppdraget (struct lin_reg_shuffle_task).
+**************************************************************************************************/
+static void* lin_reg_shuffle_next(void* arg)
+{
+   struct lin_reg_shuffle_task* task = (struct lin_reg_shuffle_task*)arg;
+   memcpy(task->destination, task->source, sizeof(size_t) * task->size);
+   lin_reg_shuffle(task->destination, task->size, task->rng_state);
+   return 0;
+}
+
+/**************************************************************************************************
+* lin_reg_random: Returnerar nsta slumptal frn en slumpgenerator av typen splitmix64. Hela
+*                 generatorns tillstnd utgrs av ett 64-bitars tal, vilket gr att randomisering
+*                 kan genomfras av en annan trd samt att tillstndet enkelt kan sparas.
+*
+*                 - rng_state: Pekare till slumpgeneratorns tillstnd.
+**************************************************************************************************/
+static uint64_t lin_reg_random(uint64_t* rng_state)
+{
+   uint64_t z = (*rng_state += 0x9e3779b97f4a7c15ULL);
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+   return z ^ (z >> 31);
+}
+
 /**************************************************************************************************
 * lin_reg_optimize: Justerar parametrar fr angiven regressionsmodell med mlsttningen att minska 
 *                   aktuell avvikelse. Prediktion genomfrs via angiven insignal, dr predikterad 
@@ -314,88 +1279,323 @@ static void lin_reg_optimize(struct lin_reg* self,
 }
 
 /**************************************************************************************************
-* lin_reg_extract: Extraherar trningsdata i form av flyttal ur angivet textstycke. Ifall tv 
-*                  flyttal lyckas extraheras s lagras dessa som en trningsuppsttning. Index 
-*                  fr trningsuppsttningen lagras ocks fr att enkelt kunna randomisera 
-*                  uppsttningarnas ordningsfljd vid trning utan att frflytta trningsdatan.
-* 
-*                  - self: Pekare till regressionsmodellen.
-*                  - s   : Pekare till textstycket som flyttal extraheras ur.
+* lin_reg_load_file: Lser in trningsdata frn angiven fil enligt beskrivningen fr funktionen
+*                    lin_reg_load_training_data_parallel.
+*
+*                    - self       : Pekare till regressionsmodellen.
+*                    - filepath   : Pekare till filskvgen.
+*                    - num_threads: Antalet trdar (0 = antalet processorkrnor).
 **************************************************************************************************/
-static void lin_reg_extract(struct lin_reg* self, 
-                            const char* s)
+static void lin_reg_load_file(struct lin_reg* self,
+                              const char* filepath,
+                              size_t num_threads)
 {
-   char num_str[20] = { '\0 ' };
-   size_t index = 0;
-   struct double_vector numbers = { .data = 0, .size = 0 };
+   FILE* fstream = fopen(filepath, "rb");
 
-   for (const char* i = s; *i; ++i)
+   if (!fstream)
    {
-      if (char_is_digit(*i))
-      {
-         num_str[index++] = *i;
-      }
-      else
-      {
-         retrieve_double(&numbers, num_str);
-         index = 0;
-      }
+      fprintf(stderr, "Could not open file at path %s!\n\n", filepath);
+      return;
+   }
+
+   const enum decompressor_format format = decompressor_detect(fstream);
+
+   if (format != DECOMPRESSOR_FORMAT_NONE)
+   {
+      lin_reg_load_compressed(self, fstream, format, filepath);
+      fclose(fstream);
+      return;
+   }
+
+   fseeko(fstream, 0, SEEK_END);
+   const off_t file_size = ftello(fstream);
+   fclose(fstream);
+   if (file_size <= 0) return;
+
+   const size_t max_threads = (size_t)(file_size / LIN_REG_MIN_CHUNK_SIZE) + 1;
+   if (!num_threads) num_threads = lin_reg_num_cpus();
+   if (num_threads > max_threads) num_threads = max_threads;
+
+   struct lin_reg_chunk* chunks = (struct lin_reg_chunk*)MEM_MALLOC(MEM_SUBSYSTEM_LOADER, sizeof(struct lin_reg_chunk) * num_threads);
+   pthread_t* threads = (pthread_t*)MEM_MALLOC(MEM_SUBSYSTEM_LOADER, sizeof(pthread_t) * num_threads);
+   bool* started = (bool*)MEM_MALLOC(MEM_SUBSYSTEM_LOADER, sizeof(bool) * num_threads);
+
+   if (!chunks || !threads || !started)
+   {
+      fprintf(stderr, "Could not allocate memory for loading file at path %s!\n\n", filepath);
+      MEM_FREE(MEM_SUBSYSTEM_LOADER, chunks);
+      MEM_FREE(MEM_SUBSYSTEM_LOADER, threads);
+      MEM_FREE(MEM_SUBSYSTEM_LOADER, started);
+      return;
    }
 
-   if (index)
+   for (size_t i = 0; i < num_threads; ++i)
    {
-      retrieve_double(&numbers, num_str);
+      chunks[i].filepath = filepath;
+      chunks[i].start = (off_t)(file_size / (off_t)num_threads * (off_t)i);
+      chunks[i].end = i + 1 < num_threads ? (off_t)(file_size / (off_t)num_threads * (off_t)(i + 1)) : file_size;
+      train_buffer_new(&chunks[i].buffer);
    }
 
-   if (numbers.size == 2)
+   for (size_t i = 1; i < num_threads; ++i)
    {
-      double_vector_push(&self->train_in, numbers.data[0]);
-      double_vector_push(&self->train_out, numbers.data[1]);
-      uint_vector_push(&self->train_order, self->train_order.size);
+      started[i] = !pthread_create(&threads[i], 0, &lin_reg_load_chunk, &chunks[i]);
    }
 
-   double_vector_delete(&numbers);
+   lin_reg_load_chunk(&chunks[0]);
+
+   for (size_t i = 1; i < num_threads; ++i)
+   {
+      if (started[i]) pthread_join(threads[i], 0);
+      else lin_reg_load_chunk(&chunks[i]);
+   }
+
+   lin_reg_append_chunks(self, chunks, num_threads);
+
+   for (size_t i = 0; i < num_threads; ++i)
+   {
+      train_buffer_delete(&chunks[i].buffer);
+   }
+
+   MEM_FREE(MEM_SUBSYSTEM_LOADER, chunks);
+   MEM_FREE(MEM_SUBSYSTEM_LOADER, threads);
+   MEM_FREE(MEM_SUBSYSTEM_LOADER, started);
    return;
 }
 
 /**************************************************************************************************
-* char_is_digit: Indikerar ifall givet tecken utgr en siffra eller ett relaterat tecken, ssom
-*                ett minustecken eller en punkt. Eftersom flyttal ibland matas in bde med
-*                punkt samt kommatecken s utgr bda giltiga tecken.
-* 
-*                - c: Det tecken som skall kontrolleras.
+* lin_reg_load_chunk: Tolkar angivet stycke av en fil med trningsdata till styckets buffert.
+*                     Filen lses blockvis, dr ofullstndiga rader i slutet av ett block flyttas
+*                     till blockets brjan infr nsta lsning. Funktionen anvnds som trdfunktion
+*                     vid parallell inlsning och returnerar drmed alltid null.
+*
+*                     - arg: Pekare till stycket (struct lin_reg_chunk).
 **************************************************************************************************/
-static bool char_is_digit(const char c)
+static void* lin_reg_load_chunk(void* arg)
 {
-   const char* s = "0123456789-.,";
+   struct lin_reg_chunk* self = (struct lin_reg_chunk*)arg;
+   FILE* fstream = fopen(self->filepath, "rb");
+   char* block = (char*)MEM_MALLOC(MEM_SUBSYSTEM_LOADER, LIN_REG_BLOCK_SIZE);
+   off_t pos = self->start;
+   size_t carry = 0;
 
-   for (const char* i = s; *i; ++i)
+   if (!fstream || !block)
    {
-      if (*i == c) return true;
+      fprintf(stderr, "Could not read file at path %s!\n\n", self->filepath);
+      if (fstream) fclose(fstream);
+      MEM_FREE(MEM_SUBSYSTEM_LOADER, block);
+      return 0;
    }
 
-   return false;
+   if (pos > 0)
+   {
+      /* Raden som pgr vid styckets start tillhr fregende stycke och hoppas drfr ver. */
+      int c = 0;
+      pos--;
+      fseeko(fstream, pos, SEEK_SET);
+
+      while ((c = fgetc(fstream)) != EOF)
+      {
+         pos++;
+         if (c == '\n') break;
+      }
+
+      if (c == EOF) pos = self->end;
+   }
+
+   while (pos < self->end)
+   {
+      const size_t num_read = fread(block + carry, 1, LIN_REG_BLOCK_SIZE - carry, fstream);
+      const size_t available = carry + num_read;
+
+      if (!num_read)
+      {
+         if (carry) train_buffer_parse_line(&self->buffer, block, block + carry);
+         break;
+      }
+
+      const off_t remaining = self->end - pos;
+      const size_t limit = remaining < (off_t)available ? (size_t)remaining : available;
+      size_t consumed = train_buffer_parse(&self->buffer, block, available, limit);
+
+      if (!consumed && available == LIN_REG_BLOCK_SIZE)
+      {
+         /* Raden ryms inte i ett block, s blocket tolkas som en egen rad. */
+         train_buffer_parse_line(&self->buffer, block, block + available);
+         consumed = available;
+      }
+
+      pos += (off_t)consumed;
+      carry = available - consumed;
+      memmove(block, block + consumed, carry);
+   }
+
+   fclose(fstream);
+   MEM_FREE(MEM_SUBSYSTEM_LOADER, block);
+   return 0;
 }
 
 /**************************************************************************************************
-* retrieve_double: Typomvandlar innehll lagrat som text till ett flyttal och lagrar resultatet
-*                  i en vektor. Innan typomvandlingen ger rum erstts eventuella kommatecken
-*                  med punkt, vilket mjliggr att flyttal kan lsas in bde med punkt eller
-*                  kommatecken som decimaltecken.
-* 
-*                  - data: Pekare till den vektor som typomvandlat flyttal skall lagras i.
-*                  - s   : Pekare till det textstycke som skall typomvandlas till ett flyttal.
+* lin_reg_load_compressed: Lser in trningsdata frn en komprimerad filstrm. Dekomprimering
+*                          och tolkning sker i tv steg i var sin trd, sammankopplade via en
+*                          begrnsad ringbuffert, s att filen aldrig behver dekomprimeras till
+*                          disk och minnestgngen r konstant. Rader som strcker sig ver flera
+*                          block stts samman via en radlsare, dr tecken utver blockstorleken
+*                          ignoreras. Vid fel lagras ingen trningsdata alls.
+*
+*                          - self    : Pekare till regressionsmodellen.
+*                          - fstream : Pekare till den komprimerade filstrmmen.
+*                          - format  : Filstrmmens komprimeringsformat.
+*                          - filepath: Pekare till filskvgen (anvnds vid felutskrifter).
+**************************************************************************************************/
+static void lin_reg_load_compressed(struct lin_reg* self,
+                                    FILE* fstream,
+                                    const enum decompressor_format format,
+                                    const char* filepath)
+{
+   struct block_queue queue;
+   struct decompressor decompressor;
+   struct lin_reg_chunk chunk = { .filepath = filepath, .start = 0, .end = 0 };
+   struct line_reader reader;
+
+   if (!decompressor_supported(format))
+   {
+      fprintf(stderr, "Could not read %s-compressed file at path %s, support not compiled in!\n\n",
+              decompressor_format_name(format), filepath);
+      return;
+   }
+
+   if (block_queue_new(&queue, LIN_REG_BLOCK_SIZE, LIN_REG_QUEUE_CAPACITY, MEM_SUBSYSTEM_LOADER))
+   {
+      fprintf(stderr, "Could not allocate memory for loading file at path %s!\n\n", filepath);
+      return;
+   }
+
+   const bool allocated = !line_reader_new(&reader, LIN_REG_BLOCK_SIZE, MEM_SUBSYSTEM_LOADER);
+   train_buffer_new(&chunk.buffer);
+   decompressor_start(&decompressor, fstream, format, &queue);
+
+   const char* block = 0;
+   size_t size = 0;
+
+   while (allocated && (block = block_queue_front(&queue, &size)))
+   {
+      line_reader_feed(&reader, block, size, lin_reg_load_line, &chunk.buffer);
+      block_queue_release(&queue);
+   }
+
+   if (!allocated) block_queue_close(&queue);
+   else line_reader_finish(&reader, lin_reg_load_line, &chunk.buffer);
+
+   if (decompressor_join(&decompressor) || !allocated)
+   {
+      fprintf(stderr, "Could not decompress %s-compressed file at path %s!\n\n",
+              decompressor_format_name(format), filepath);
+   }
+   else
+   {
+      lin_reg_append_chunks(self, &chunk, 1);
+   }
+
+   train_buffer_delete(&chunk.buffer);
+   block_queue_delete(&queue);
+   line_reader_delete(&reader);
+   return;
+}
+
+/**************************************************************************************************
+* lin_reg_load_line: Tolkar en komplett textrad som en trningsuppsttning i angiven buffert.
+*                    Anvnds som radhanterare vid inlsning av komprimerade filer, dr rader
+*                    som inte innehller exakt tv tal ignoreras. Returnerar alltid true.
+*
+*                    - context: Pekare till bufferten som trningsuppsttningen lagras i.
+*                    - begin  : Pekare till radens frsta tecken.
+*                    - end    : Pekare direkt efter radens sista tecken.
+**************************************************************************************************/
+static bool lin_reg_load_line(void* context,
+                              const char* begin,
+                              const char* end)
+{
+   train_buffer_parse_line((struct train_buffer*)context, begin, end);
+   return true;
+}
+
+/**************************************************************************************************
+* lin_reg_append_chunks: Lgger till trningsuppsttningar tolkade ur angivna filstycken lngst
+*                        bak i angiven regressionsmodell. Respektive stycke kopieras till en
+*                        position given av summan av antalet uppsttningar i fregende stycken,
+*                        vilket bevarar filens ordningsfljd. Ifall minnet inte rcker terstlls
+*                        samtliga vektorer till ursprunglig storlek, s att modellen aldrig lmnas
+*                        med vektorer av olika storlek.
+*
+*                        - self      : Pekare till regressionsmodellen.
+*                        - chunks    : Pekare till array innehllande tolkade filstycken.
+*                        - num_chunks: Antalet filstycken.
 **************************************************************************************************/
-static void retrieve_double(struct double_vector* data, 
-                            char* s)
+static void lin_reg_append_chunks(struct lin_reg* self,
+                                  struct lin_reg_chunk* chunks,
+                                  const size_t num_chunks)
 {
-   for (char* i = s; *i; ++i)
+   const size_t old_size = self->train_in.size;
+   size_t new_size = old_size;
+
+   for (size_t i = 0; i < num_chunks; ++i)
    {
-      if (*i == ',') *i = '.';
+      new_size += chunks[i].buffer.size;
    }
 
-   const double num = atof(s);
-   double_vector_push(data, num);
-   s[0] = '\0';
+   if (new_size == old_size) return;
+
+   if (double_vector_resize(&self->train_in, new_size) ||
+       double_vector_resize(&self->train_out, new_size) ||
+       uint_vector_resize(&self->train_order, new_size))
+   {
+      fprintf(stderr, "Could not allocate memory for %zu training sets!\n\n", new_size);
+
+      if (old_size)
+      {
+         double_vector_resize(&self->train_in, old_size);
+         double_vector_resize(&self->train_out, old_size);
+         uint_vector_resize(&self->train_order, old_size);
+      }
+      else
+      {
+         double_vector_delete(&self->train_in);
+         double_vector_delete(&self->train_out);
+         uint_vector_delete(&self->train_order);
+      }
+
+      return;
+   }
+
+   size_t offset = old_size;
+
+   for (size_t i = 0; i < num_chunks; ++i)
+   {
+      const struct train_buffer* buffer = &chunks[i].buffer;
+      memcpy(self->train_in.data + offset, buffer->in.data, sizeof(double) * buffer->size);
+      memcpy(self->train_out.data + offset, buffer->out.data, sizeof(double) * buffer->size);
+
+      for (size_t j = 0; j < buffer->size; ++j)
+      {
+         self->train_order.data[offset + j] = offset + j;
+      }
+
+      offset += buffer->size;
+   }
+
+   self->scale_cached = false;
    return;
+}
+
+/**************************************************************************************************
+* lin_reg_num_cpus: Returnerar antalet tillgngliga processorkrnor, dock minst en.
+**************************************************************************************************/
+static size_t lin_reg_num_cpus(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+   const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   if (num_cpus > 0) return (size_t)num_cpus;
+#endif /* _SC_NPROCESSORS_ONLN */
+   return 1;
 }
\ No newline at end of file
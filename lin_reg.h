@@ -9,8 +9,34 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/types.h>
 #include "double_vector.h"
 #include "uint_vector.h"
+#include "train_buffer.h"
+#include "block_queue.h"
+#include "decompressor.h"
+#include "perf_counters.h"
+#include "checkpoint.h"
+#include "score_pipeline.h"
+#include "mem_stats.h"
+
+/**************************************************************************************************
+* lin_reg_scale: Medelvrden samt standardavvikelser fr trningsdatans in- och utsignaler, som
+*                anvnds vid trning i standardiserad rymd.
+**************************************************************************************************/
+struct lin_reg_scale
+{
+   double mean_in;  /* Insignalernas medelvrde. */
+   double std_in;   /* Insignalernas standardavvikelse. */
+   double mean_out; /* Utsignalernas medelvrde. */
+   double std_out;  /* Utsignalernas standardavvikelse. */
+};
 
 /**************************************************************************************************
 * lin_reg: Strukt fr implementering av maskininlrningsmodeller baserade p linjr regression. 
@@ -24,6 +50,15 @@ struct lin_reg
    struct uint_vector train_order; /* Lagrar trningsuppsttningarnas ordningsfljd. */
    double bias;                    /* Vilovrde (m-vrde). */
    double weight;                  /* Lutning (k-vrde). */
+   struct perf_counters* perf;     /* Pekare till hrdvarurknare fr mtning (null = av). */
+   uint64_t rng_state;             /* Slumpgeneratorns tillstnd vid randomisering. */
+   bool pipelined_shuffle;         /* Indikerar ifall nsta epoks ordningsfljd tas fram parallellt. */
+   uint64_t epoch;                 /* Antalet genomfrda epoker. */
+   struct checkpoint* checkpoint;  /* Pekare till kontrollpunkter under trning (null = av). */
+   bool standardize;               /* Indikerar ifall trning sker i standardiserad rymd. */
+   const struct lin_reg_scale* scale; /* Pekare till aktuell skalning under trning (null = av). */
+   struct lin_reg_scale scale_cache;  /* Senast berknade skalning fr aktuell trningsdata. */
+   bool scale_cached;                 /* Indikerar ifall scale_cache gller aktuell trningsdata. */
 };
 
 /* Externa funktioner: */
@@ -31,8 +66,21 @@ void lin_reg_new(struct lin_reg* self);
 void lin_reg_delete(struct lin_reg* self);
 struct lin_reg* lin_reg_ptr_new(void);
 void lin_reg_ptr_delete(struct lin_reg** self);
+void lin_reg_set_perf_counters(struct lin_reg* self,
+                               struct perf_counters* perf);
+void lin_reg_set_seed(struct lin_reg* self,
+                      const uint64_t seed);
+void lin_reg_set_pipelined_shuffle(struct lin_reg* self,
+                                   const bool pipelined_shuffle);
+void lin_reg_set_checkpoint(struct lin_reg* self,
+                            struct checkpoint* checkpoint);
+void lin_reg_set_standardize(struct lin_reg* self,
+                             const bool standardize);
 void lin_reg_load_training_data(struct lin_reg* self, 
                                 const char* filepath);
+void lin_reg_load_training_data_parallel(struct lin_reg* self,
+                                         const char* filepath,
+                                         size_t num_threads);
 void lin_reg_set_training_data(struct lin_reg* self,
                                const double* train_in, 
                                const double* train_out, 
@@ -40,6 +88,20 @@ void lin_reg_set_training_data(struct lin_reg* self,
 void lin_reg_train(struct lin_reg* self,
                    const size_t num_epochs,
                    const double learning_rate);
+void lin_reg_train_hogwild(struct lin_reg* self,
+                           const size_t num_epochs,
+                           const double learning_rate,
+                           size_t num_threads);
+size_t lin_reg_train_progressive(struct lin_reg* self,
+                                 const double learning_rate,
+                                 const size_t initial_size,
+                                 const size_t epochs_per_stage,
+                                 const double tolerance);
+int lin_reg_resume(struct lin_reg* self,
+                   const char* filepath,
+                   const size_t num_epochs,
+                   const double learning_rate);
+double lin_reg_mean_squared_error(const struct lin_reg* self);
 double lin_reg_predict(const struct lin_reg* self, 
                        const double input);
 void lin_reg_predict_all(const struct lin_reg* self,
@@ -51,5 +113,10 @@ void lin_reg_predict_range(const struct lin_reg* self,
                            const double step, 
                            const double threshold, 
                            FILE* ostream);
+int lin_reg_score_file(const struct lin_reg* self,
+                       const char* input_path,
+                       const char* output_path,
+                       const enum score_pipeline_format format,
+                       struct score_pipeline_stats* stats);
 
 #endif /* LIN_REG_H_ */
\ No newline at end of file
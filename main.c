@@ -4,7 +4,11 @@
 *         precision, vilket indikerar lyckad trning.
 *
 *         Kompilera koden och skapa en krbar fil dpt main.exe med fljande kommando:
-*         $ gcc main.c lin_reg.c double_vector.c uint_vector.c -o main.exe -Wall
+*         $ gcc main.c lin_reg.c double_vector.c uint_vector.c train_buffer.c block_queue.c decompressor.c perf_counters.c checkpoint.c mem_stats.c score_pipeline.c -o main.exe -Wall -pthread -lm
+*
+*         Fr inlsning av trningsdata komprimerad med gzip och/eller zstd, lgg till
+*         -DLIN_REG_USE_ZLIB -lz och/eller -DLIN_REG_USE_ZSTD -lzstd i kommandot ovan.
+*         Fr redovisning av minnesanvndning per delsystem, lgg till -DLIN_REG_MEM_STATS.
 *
 *         Kr sedan programmet med fljande kommando:
 *         $ main.exe
@@ -0,0 +1,258 @@
+/**************************************************************************************************
+* mem_stats.c: Innehller funktionsdefinitioner fr minnesredovisning per delsystem.
+**************************************************************************************************/
+#include "mem_stats.h"
+
+#ifdef LIN_REG_MEM_STATS
+#include <stdatomic.h>
+
+/**************************************************************************************************
+* mem_stats_header: Huvud som placeras fre varje redovisat minnesblock och lagrar blockets
+*                   storlek, s att storleken r knd vid omallokering och frigring. Huvudet
+*                   har samma justering som max_align_t, s returnerade pekare r justerade
+*                   precis som vid anrop av malloc.
+**************************************************************************************************/
+union mem_stats_header
+{
+   size_t size;         /* Minnesblockets storlek i byte (exklusive huvudet). */
+   max_align_t padding; /* Skerstller korrekt justering av minnesblocket. */
+};
+
+/**************************************************************************************************
+* mem_stats_counters: Atomiska rknare fr ett delsystem, som uppdateras lock-fritt eftersom
+*                     allokeringar sker frn flera trdar samtidigt vid parallell inlsning.
+**************************************************************************************************/
+struct mem_stats_counters
+{
+   atomic_size_t current_bytes; /* Aktuellt antal allokerade byte. */
+   atomic_size_t peak_bytes;    /* Maximalt antal allokerade byte samtidigt. */
+   atomic_size_t allocations;   /* Antalet nya allokeringar. */
+   atomic_size_t reallocations; /* Antalet omallokeringar. */
+   atomic_size_t frees;         /* Antalet frigjorda minnesblock. */
+};
+
+/* Statiska variabler: */
+static struct mem_stats_counters mem_stats_subsystems[MEM_SUBSYSTEM_COUNT];
+static struct mem_stats_counters mem_stats_total;
+
+// Statiska funktioner:
+static void mem_stats_add(struct mem_stats_counters* counters,
+                          const size_t old_size,
+                          const size_t new_size);
+static void mem_stats_account(const enum mem_subsystem subsystem,
+                              const size_t old_size,
+                              const size_t new_size);
+static void mem_stats_load(const struct mem_stats_counters* counters,
+                           struct mem_stats_entry* entry);
+
+/**************************************************************************************************
+* mem_stats_malloc: Allokerar ett minnesblock av angiven storlek och redovisar detta fr angivet
+*                   delsystem. Returnerar en pekare till minnesblocket, alternativt null.
+*
+*                   - subsystem: Delsystemet som allokeringen redovisas fr.
+*                   - size     : Minnesblockets storlek i byte.
+**************************************************************************************************/
+void* mem_stats_malloc(const enum mem_subsystem subsystem,
+                       const size_t size)
+{
+   union mem_stats_header* header = (union mem_stats_header*)malloc(sizeof(union mem_stats_header) + size);
+   if (!header) return 0;
+   header->size = size;
+   mem_stats_account(subsystem, 0, size);
+   atomic_fetch_add(&mem_stats_subsystems[subsystem].allocations, 1);
+   atomic_fetch_add(&mem_stats_total.allocations, 1);
+   return header + 1;
+}
+
+/**************************************************************************************************
+* mem_stats_realloc: Omallokerar angivet minnesblock till angiven storlek och redovisar
+*                    frndringen fr angivet delsystem. En nullpekare allokerar ett nytt block.
+*                    Returnerar en pekare till minnesblocket, alternativt null, dr ursprungligt
+*                    block d lmnas orrt precis som vid anrop av realloc.
+*
+*                    - subsystem: Delsystemet som omallokeringen redovisas fr.
+*                    - ptr      : Pekare till minnesblocket som skall omallokeras.
+*                    - size     : Minnesblockets nya storlek i byte.
+**************************************************************************************************/
+void* mem_stats_realloc(const enum mem_subsystem subsystem,
+                        void* ptr,
+                        const size_t size)
+{
+   if (!ptr) return mem_stats_malloc(subsystem, size);
+   union mem_stats_header* header = (union mem_stats_header*)ptr - 1;
+   const size_t old_size = header->size;
+   header = (union mem_stats_header*)realloc(header, sizeof(union mem_stats_header) + size);
+   if (!header) return 0;
+   header->size = size;
+   mem_stats_account(subsystem, old_size, size);
+   atomic_fetch_add(&mem_stats_subsystems[subsystem].reallocations, 1);
+   atomic_fetch_add(&mem_stats_total.reallocations, 1);
+   return header + 1;
+}
+
+/**************************************************************************************************
+* mem_stats_free: Frigr angivet minnesblock och redovisar detta fr angivet delsystem.
+*
+*                 - subsystem: Delsystemet som minnesblocket redovisades fr vid allokering.
+*                 - ptr      : Pekare till minnesblocket (null ignoreras).
+**************************************************************************************************/
+void mem_stats_free(const enum mem_subsystem subsystem,
+                    void* ptr)
+{
+   if (!ptr) return;
+   union mem_stats_header* header = (union mem_stats_header*)ptr - 1;
+   mem_stats_account(subsystem, header->size, 0);
+   atomic_fetch_add(&mem_stats_subsystems[subsystem].frees, 1);
+   atomic_fetch_add(&mem_stats_total.frees, 1);
+   free(header);
+   return;
+}
+#endif /* LIN_REG_MEM_STATS */
+
+/**************************************************************************************************
+* mem_stats_enabled: Indikerar ifall minnesredovisning r aktiverad i aktuell build.
+**************************************************************************************************/
+bool mem_stats_enabled(void)
+{
+#ifdef LIN_REG_MEM_STATS
+   return true;
+#else
+   return false;
+#endif /* LIN_REG_MEM_STATS */
+}
+
+/**************************************************************************************************
+* mem_stats_get: Lser av aktuell minnesstatistik fr angivet delsystem. Ifall redovisningen
+*                inte r aktiverad nollstlls samtliga vrden.
+*
+*                - subsystem: Delsystemet som skall lsas av.
+*                - entry    : Pekare till strukten dr statistiken lagras.
+**************************************************************************************************/
+void mem_stats_get(const enum mem_subsystem subsystem,
+                   struct mem_stats_entry* entry)
+{
+#ifdef LIN_REG_MEM_STATS
+   mem_stats_load(&mem_stats_subsystems[subsystem], entry);
+#else
+   (void)subsystem;
+   entry->current_bytes = entry->peak_bytes = 0;
+   entry->allocations = entry->reallocations = entry->frees = 0;
+#endif /* LIN_REG_MEM_STATS */
+   return;
+}
+
+/**************************************************************************************************
+* mem_stats_get_total: Lser av aktuell minnesstatistik fr samtliga delsystem tillsammans, dr
+*                      maxvrdet avser det strsta antalet byte som har varit allokerade
+*                      samtidigt totalt sett. Ifall redovisningen inte r aktiverad nollstlls
+*                      samtliga vrden.
+*
+*                      - entry: Pekare till strukten dr statistiken lagras.
+**************************************************************************************************/
+void mem_stats_get_total(struct mem_stats_entry* entry)
+{
+#ifdef LIN_REG_MEM_STATS
+   mem_stats_load(&mem_stats_total, entry);
+#else
+   entry->current_bytes = entry->peak_bytes = 0;
+   entry->allocations = entry->reallocations = entry->frees = 0;
+#endif /* LIN_REG_MEM_STATS */
+   return;
+}
+
+/**************************************************************************************************
+* mem_stats_print: Skriver ut minnesstatistik fr samtliga delsystem via angiven utstrm, dr
+*                  standardutenheten stdout anvnds som default fr utskrift i terminalen.
+*
+*                  - ostream: Pekare till angiven utstrm (default = stdout).
+**************************************************************************************************/
+void mem_stats_print(FILE* ostream)
+{
+   const char* names[MEM_SUBSYSTEM_COUNT] = { "double_vector", "uint_vector", "model",
+                                              "loader", "training", "scoring" };
+   struct mem_stats_entry entry;
+   if (!ostream) ostream = stdout;
+   fprintf(ostream, "--------------------------------------------------------------------------\n");
+
+   if (!mem_stats_enabled())
+   {
+      fprintf(ostream, "Memory accounting disabled, compile with -DLIN_REG_MEM_STATS.\n");
+      fprintf(ostream, "--------------------------------------------------------------------------\n\n");
+      return;
+   }
+
+   fprintf(ostream, "%-14s %14s %14s %10s %10s %10s\n",
+           "Subsystem", "Current [B]", "Peak [B]", "Allocs", "Reallocs", "Frees");
+
+   for (size_t i = 0; i < MEM_SUBSYSTEM_COUNT; ++i)
+   {
+      mem_stats_get((enum mem_subsystem)i, &entry);
+      fprintf(ostream, "%-14s %14zu %14zu %10zu %10zu %10zu\n", names[i], entry.current_bytes,
+              entry.peak_bytes, entry.allocations, entry.reallocations, entry.frees);
+   }
+
+   mem_stats_get_total(&entry);
+   fprintf(ostream, "%-14s %14zu %14zu %10zu %10zu %10zu\n", "total", entry.current_bytes,
+           entry.peak_bytes, entry.allocations, entry.reallocations, entry.frees);
+   fprintf(ostream, "--------------------------------------------------------------------------\n\n");
+   return;
+}
+
+#ifdef LIN_REG_MEM_STATS
+/**************************************************************************************************
+* mem_stats_add: Uppdaterar angivna rknares aktuella samt maximala antal allokerade byte nr
+*                ett minnesblock ndrar storlek frn angiven gammal till angiven ny storlek.
+*
+*                - counters: Pekare till rknarna.
+*                - old_size: Minnesblockets tidigare storlek i byte (0 vid ny allokering).
+*                - new_size: Minnesblockets nya storlek i byte (0 vid frigring).
+**************************************************************************************************/
+static void mem_stats_add(struct mem_stats_counters* counters,
+                          const size_t old_size,
+                          const size_t new_size)
+{
+   const size_t current = new_size >= old_size ?
+      atomic_fetch_add(&counters->current_bytes, new_size - old_size) + (new_size - old_size) :
+      atomic_fetch_sub(&counters->current_bytes, old_size - new_size) - (old_size - new_size);
+   size_t peak = atomic_load(&counters->peak_bytes);
+
+   while (current > peak && !atomic_compare_exchange_weak(&counters->peak_bytes, &peak, current))
+   {
+   }
+
+   return;
+}
+
+/**************************************************************************************************
+* mem_stats_account: Redovisar en storleksfrndring fr angivet delsystem samt totalt.
+*
+*                    - subsystem: Delsystemet som frndringen redovisas fr.
+*                    - old_size : Minnesblockets tidigare storlek i byte.
+*                    - new_size : Minnesblockets nya storlek i byte.
+**************************************************************************************************/
+static void mem_stats_account(const enum mem_subsystem subsystem,
+                              const size_t old_size,
+                              const size_t new_size)
+{
+   mem_stats_add(&mem_stats_subsystems[subsystem], old_size, new_size);
+   mem_stats_add(&mem_stats_total, old_size, new_size);
+   return;
+}
+
+/**************************************************************************************************
+* mem_stats_load: Lser av angivna rknare till angiven statistikstrukt.
+*
+*                 - counters: Pekare till rknarna.
+*                 - entry   : Pekare till strukten dr statistiken lagras.
+**************************************************************************************************/
+static void mem_stats_load(const struct mem_stats_counters* counters,
+                           struct mem_stats_entry* entry)
+{
+   entry->current_bytes = atomic_load(&counters->current_bytes);
+   entry->peak_bytes = atomic_load(&counters->peak_bytes);
+   entry->allocations = atomic_load(&counters->allocations);
+   entry->reallocations = atomic_load(&counters->reallocations);
+   entry->frees = atomic_load(&counters->frees);
+   return;
+}
+#endif /* LIN_REG_MEM_STATS */
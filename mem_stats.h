@@ -0,0 +1,74 @@
+/**************************************************************************************************
+* mem_stats.h: Implementering av minnesredovisning fr vektorer, regressionsmodeller samt
+*              temporra buffertar vid inlsning, trning och prediktion. Fr varje delsystem
+*              rknas aktuellt samt maximalt antal allokerade byte, antalet allokeringar,
+*              omallokeringar samt frigringar, vilket kan lsas av under krning via
+*              mem_stats_get eller skrivas ut via mem_stats_print.
+*
+*              Redovisningen aktiveras genom att kompilera med -DLIN_REG_MEM_STATS. Annars
+*              expanderas makrona MEM_MALLOC, MEM_REALLOC samt MEM_FREE direkt till malloc,
+*              realloc samt free, s att redovisningen inte kostar ngonting.
+**************************************************************************************************/
+#ifndef MEM_STATS_H_
+#define MEM_STATS_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**************************************************************************************************
+* mem_subsystem: Enumeration fr de delsystem vars minnesanvndning redovisas.
+**************************************************************************************************/
+enum mem_subsystem
+{
+   MEM_SUBSYSTEM_DOUBLE_VECTOR, /* Vektorer fr flyttal. */
+   MEM_SUBSYSTEM_UINT_VECTOR,   /* Vektorer fr osignerade heltal (ordningsfljder). */
+   MEM_SUBSYSTEM_MODEL,         /* Heapallokerade regressionsmodeller. */
+   MEM_SUBSYSTEM_LOADER,        /* Temporra block, tolkningsbuffertar och trdar vid inlsning. */
+   MEM_SUBSYSTEM_TRAINING,      /* Temporra strukturer vid trning samt kontrollpunkter. */
+   MEM_SUBSYSTEM_SCORING,       /* Ringbuffertar och radbuffertar vid strmmande prediktion. */
+   MEM_SUBSYSTEM_COUNT          /* Antalet delsystem. */
+};
+
+/**************************************************************************************************
+* mem_stats_entry: Minnesstatistik fr ett delsystem, alternativt samtliga delsystem.
+**************************************************************************************************/
+struct mem_stats_entry
+{
+   size_t current_bytes; /* Aktuellt antal allokerade byte. */
+   size_t peak_bytes;    /* Maximalt antal allokerade byte samtidigt. */
+   size_t allocations;   /* Antalet nya allokeringar. */
+   size_t reallocations; /* Antalet omallokeringar av befintliga minnesblock. */
+   size_t frees;         /* Antalet frigjorda minnesblock. */
+};
+
+/* Makrodefinitioner: */
+#ifdef LIN_REG_MEM_STATS
+#define MEM_MALLOC(subsystem, size) mem_stats_malloc(subsystem, size)
+#define MEM_REALLOC(subsystem, ptr, size) mem_stats_realloc(subsystem, ptr, size)
+#define MEM_FREE(subsystem, ptr) mem_stats_free(subsystem, ptr)
+#else
+#define MEM_MALLOC(subsystem, size) malloc(size)
+#define MEM_REALLOC(subsystem, ptr, size) realloc(ptr, size)
+#define MEM_FREE(subsystem, ptr) free(ptr)
+#endif /* LIN_REG_MEM_STATS */
+
+/* Externa funktioner: */
+#ifdef LIN_REG_MEM_STATS
+void* mem_stats_malloc(const enum mem_subsystem subsystem,
+                       const size_t size);
+void* mem_stats_realloc(const enum mem_subsystem subsystem,
+                        void* ptr,
+                        const size_t size);
+void mem_stats_free(const enum mem_subsystem subsystem,
+                    void* ptr);
+#endif /* LIN_REG_MEM_STATS */
+bool mem_stats_enabled(void);
+void mem_stats_get(const enum mem_subsystem subsystem,
+                   struct mem_stats_entry* entry);
+void mem_stats_get_total(struct mem_stats_entry* entry);
+void mem_stats_print(FILE* ostream);
+
+#endif /* MEM_STATS_H_ */
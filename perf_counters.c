@@ -0,0 +1,294 @@
+/**************************************************************************************************
+* perf_counters.c: Innehller funktionsdefinitioner fr mtning av hrdvarurknare per fas via
+*                  strukten perf_counters.
+**************************************************************************************************/
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif /* __linux__ */
+
+// Statiska funktioner:
+static int perf_counters_open(const enum perf_counter counter,
+                              const int group_fd);
+static struct perf_sample perf_counters_read(const int fd);
+static void perf_counters_print_rate(const uint64_t numerator,
+                                     const uint64_t denominator,
+                                     const double scale,
+                                     const bool available,
+                                     FILE* ostream);
+
+/**************************************************************************************************
+* perf_counters_new: Initierar angiven strukt och ppnar samtliga hrdvarurknare fr anropande
+*                    trd. Rknarna ppnas som en grupp med klockcykler som ledare. Rknare som
+*                    inte kan lggas till i gruppen ppnas separat, medan rknare som inte kan
+*                    ppnas alls markeras som saknade och rapporteras drefter som ej tillgngliga.
+*
+*                    - self: Pekare till strukten.
+**************************************************************************************************/
+void perf_counters_new(struct perf_counters* self)
+{
+   for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+   {
+      const int leader = i ? self->fds[PERF_COUNTER_CYCLES] : -1;
+      self->fds[i] = perf_counters_open((enum perf_counter)i, leader);
+      if (self->fds[i] < 0 && leader >= 0) self->fds[i] = perf_counters_open((enum perf_counter)i, -1);
+      self->start[i].valid = false;
+   }
+
+   for (size_t i = 0; i < PERF_PHASE_COUNT; ++i)
+   {
+      for (size_t j = 0; j < PERF_COUNTER_COUNT; ++j)
+      {
+         self->totals[i][j] = 0;
+      }
+
+      self->seconds[i] = 0;
+      self->calls[i] = 0;
+   }
+
+   self->start_time.tv_sec = 0;
+   self->start_time.tv_nsec = 0;
+   return;
+}
+
+/**************************************************************************************************
+* perf_counters_delete: Stnger samtliga ppnade hrdvarurknare fr angiven strukt.
+*
+*                       - self: Pekare till strukten.
+**************************************************************************************************/
+void perf_counters_delete(struct perf_counters* self)
+{
+   for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+   {
+#ifdef __linux__
+      if (self->fds[i] >= 0) close(self->fds[i]);
+#endif /* __linux__ */
+      self->fds[i] = -1;
+   }
+
+   return;
+}
+
+/**************************************************************************************************
+* perf_counters_available: Indikerar ifall minst en hrdvarurknare kunde ppnas.
+*
+*                          - self: Pekare till strukten.
+**************************************************************************************************/
+bool perf_counters_available(const struct perf_counters* self)
+{
+   for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+   {
+      if (self->fds[i] >= 0) return true;
+   }
+
+   return false;
+}
+
+/**************************************************************************************************
+* perf_counters_begin: Pbrjar mtning av angiven fas genom att lagra aktuella rknarvrden
+*                      samt aktuell tidpunkt.
+*
+*                      - self : Pekare till strukten.
+*                      - phase: Fasen som skall mtas.
+**************************************************************************************************/
+void perf_counters_begin(struct perf_counters* self,
+                         const enum perf_phase phase)
+{
+   (void)phase;
+
+   for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+   {
+      self->start[i] = perf_counters_read(self->fds[i]);
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &self->start_time);
+   return;
+}
+
+/**************************************************************************************************
+* perf_counters_end: Avslutar mtning av angiven fas och adderar skillnaden mellan aktuella
+*                    rknarvrden och vrdena vid fasens brjan till fasens totalvrden. Ifall
+*                    rknaren har multiplexerats skalas skillnaden med kvoten mellan aktiverad
+*                    och faktiskt rknande tid under fasen. Misslyckade avlsningar samt faser
+*                    dr rknaren aldrig rknade ger inget bidrag.
+*
+*                    - self : Pekare till strukten.
+*                    - phase: Fasen som mts.
+**************************************************************************************************/
+void perf_counters_end(struct perf_counters* self,
+                       const enum perf_phase phase)
+{
+   const double seconds = perf_counters_elapsed(&self->start_time);
+
+   for (size_t i = 0; i < PERF_COUNTER_COUNT; ++i)
+   {
+      const struct perf_sample* start = &self->start[i];
+      const struct perf_sample end = perf_counters_read(self->fds[i]);
+      if (!start->valid || !end.valid || end.value < start->value) continue;
+
+      const uint64_t enabled = end.time_enabled - start->time_enabled;
+      const uint64_t running = end.time_running - start->time_running;
+      const uint64_t delta = end.value - start->value;
+      if (!running) continue;
+
+      self->totals[phase][i] += running < enabled ?
+         (uint64_t)((double)delta * (double)enabled / (double)running) : delta;
+   }
+
+   self->seconds[phase] += seconds;
+   self->calls[phase]++;
+   return;
+}
+
+/**************************************************************************************************
+* perf_counters_print: Skriver ut uppmtta vrden fr samtliga uppmtta faser via angiven
+*                      utstrm, dr standardutenheten stdout anvnds som default. Fr varje fas
+*                      skrivs antalet instruktioner per klockcykel (IPC) samt antalet cachemissar
+*                      och felpredikterade hopp per tusen instruktioner ut. Vrden fr rknare
+*                      som saknas skrivs ut som n/a.
+*
+*                      - self   : Pekare till strukten.
+*                      - ostream: Pekare till angiven utstrm (default = stdout).
+**************************************************************************************************/
+void perf_counters_print(const struct perf_counters* self,
+                         FILE* ostream)
+{
+   const char* names[PERF_PHASE_COUNT] = { "load", "shuffle", "update", "predict" };
+   const bool cycles = self->fds[PERF_COUNTER_CYCLES] >= 0;
+   const bool instructions = self->fds[PERF_COUNTER_INSTRUCTIONS] >= 0;
+   const bool llc_misses = self->fds[PERF_COUNTER_LLC_MISSES] >= 0;
+   const bool branch_misses = self->fds[PERF_COUNTER_BRANCH_MISSES] >= 0;
+   if (!ostream) ostream = stdout;
+
+   fprintf(ostream, "--------------------------------------------------------------------------\n");
+   fprintf(ostream, "%-8s %8s %12s %14s %14s %14s\n",
+           "Phase", "Calls", "Time [s]", "IPC", "LLC/kinstr", "Branch/kinstr");
+
+   for (size_t i = 0; i < PERF_PHASE_COUNT; ++i)
+   {
+      const uint64_t* totals = self->totals[i];
+      if (!self->calls[i]) continue;
+
+      fprintf(ostream, "%-8s %8zu %12.6f", names[i], self->calls[i], self->seconds[i]);
+      perf_counters_print_rate(totals[PERF_COUNTER_INSTRUCTIONS], totals[PERF_COUNTER_CYCLES],
+                               1.0, instructions && cycles, ostream);
+      perf_counters_print_rate(totals[PERF_COUNTER_LLC_MISSES], totals[PERF_COUNTER_INSTRUCTIONS],
+                               1000.0, llc_misses && instructions, ostream);
+      perf_counters_print_rate(totals[PERF_COUNTER_BRANCH_MISSES], totals[PERF_COUNTER_INSTRUCTIONS],
+                               1000.0, branch_misses && instructions, ostream);
+      fprintf(ostream, "\n");
+   }
+
+   if (!perf_counters_available(self))
+   {
+      fprintf(ostream, "Hardware performance counters unavailable, only time was measured.\n");
+   }
+
+   fprintf(ostream, "--------------------------------------------------------------------------\n\n");
+   return;
+}
+
+/**************************************************************************************************
+* perf_counters_elapsed: Returnerar antalet sekunder som har frflutit sedan angiven tidpunkt,
+*                        mtt med den monotona klockan CLOCK_MONOTONIC. Anvnds fr samtliga
+*                        tidsmtningar, ven dr hrdvarurknare inte anvnds.
+*
+*                        - start: Pekare till tidpunkten, avlst via CLOCK_MONOTONIC.
+**************************************************************************************************/
+double perf_counters_elapsed(const struct timespec* start)
+{
+   struct timespec end;
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   return (double)(end.tv_sec - start->tv_sec) + (double)(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**************************************************************************************************
+* perf_counters_open: ppnar angiven hrdvarurknare fr anropande trd samt trdar som skapas
+*                     drefter. Endast hndelser i anvndarlge rknas, vilket gr att rknarna
+*                     kan anvndas utan utkade rttigheter p de flesta system. Aktiverad samt
+*                     faktiskt rknande tid lses tillsammans med vrdet, s att multiplexering
+*                     kan kompenseras. Returnerar rknarens fildeskriptor, alternativt -1 ifall
+*                     rknaren inte kunde ppnas.
+*
+*                     - counter : Rknaren som skall ppnas.
+*                     - group_fd: Fildeskriptor fr gruppens ledare (-1 = rknaren blir ledare).
+**************************************************************************************************/
+static int perf_counters_open(const enum perf_counter counter,
+                              const int group_fd)
+{
+#ifdef __linux__
+   const uint64_t configs[PERF_COUNTER_COUNT] = { PERF_COUNT_HW_CPU_CYCLES,
+                                                  PERF_COUNT_HW_INSTRUCTIONS,
+                                                  PERF_COUNT_HW_CACHE_MISSES,
+                                                  PERF_COUNT_HW_BRANCH_MISSES };
+   struct perf_event_attr attr;
+   memset(&attr, 0, sizeof(attr));
+   attr.type = PERF_TYPE_HARDWARE;
+   attr.size = sizeof(attr);
+   attr.config = configs[counter];
+   attr.inherit = 1;
+   attr.exclude_kernel = 1;
+   attr.exclude_hv = 1;
+   attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+   return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+#else
+   (void)counter;
+   (void)group_fd;
+   return -1;
+#endif /* __linux__ */
+}
+
+/**************************************************************************************************
+* perf_counters_read: Returnerar aktuellt vrde samt aktiverad och rknande tid fr
+*                     hrdvarurknaren med angiven fildeskriptor. Ifall rknaren saknas eller
+*                     inte kunde lsas markeras avlsningen som ogiltig.
+*
+*                     - fd: Rknarens fildeskriptor.
+**************************************************************************************************/
+static struct perf_sample perf_counters_read(const int fd)
+{
+   struct perf_sample sample = { 0, 0, 0, false };
+#ifdef __linux__
+   uint64_t values[3] = { 0 };
+   if (fd < 0 || read(fd, values, sizeof(values)) != (ssize_t)sizeof(values)) return sample;
+   sample.value = values[0];
+   sample.time_enabled = values[1];
+   sample.time_running = values[2];
+   sample.valid = true;
+#else
+   (void)fd;
+#endif /* __linux__ */
+   return sample;
+}
+
+/**************************************************************************************************
+* perf_counters_print_rate: Skriver ut kvoten mellan angiven tljare och nmnare multiplicerad
+*                           med angiven skalfaktor, alternativt n/a ifall kvoten saknas.
+*
+*                           - numerator  : Kvotens tljare.
+*                           - denominator: Kvotens nmnare.
+*                           - scale      : Skalfaktor fr kvoten.
+*                           - available  : Indikerar ifall underliggande rknare finns.
+*                           - ostream    : Pekare till angiven utstrm.
+**************************************************************************************************/
+static void perf_counters_print_rate(const uint64_t numerator,
+                                     const uint64_t denominator,
+                                     const double scale,
+                                     const bool available,
+                                     FILE* ostream)
+{
+   if (available && denominator)
+   {
+      fprintf(ostream, " %14.4f", scale * (double)numerator / (double)denominator);
+   }
+   else
+   {
+      fprintf(ostream, " %14s", "n/a");
+   }
+
+   return;
+}
@@ -0,0 +1,85 @@
+/**************************************************************************************************
+* perf_counters.h: Implementering av mtning av hrdvarurknare (klockcykler, instruktioner,
+*                  cachemissar i sista cachenivn samt felpredikterade hopp) fr olika faser av
+*                  inlsning, trning och prediktion via strukten perf_counters samt motsvarande
+*                  externa funktioner. Rknarna lses via perf_event_open p Linux. Ifall rknarna
+*                  inte r tillgngliga (exempelvis p andra plattformar, i virtuella maskiner
+*                  eller vid otillrckliga rttigheter) mts endast tidstgngen fr varje fas.
+**************************************************************************************************/
+#ifndef PERF_COUNTERS_H_
+#define PERF_COUNTERS_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/**************************************************************************************************
+* perf_phase: Enumeration fr de faser som kan mtas.
+**************************************************************************************************/
+enum perf_phase
+{
+   PERF_PHASE_LOAD,    /* Inlsning av trningsdata. */
+   PERF_PHASE_SHUFFLE, /* Randomisering av trningsuppsttningarnas ordningsfljd. */
+   PERF_PHASE_UPDATE,  /* Justering av modellens parametrar under trning. */
+   PERF_PHASE_PREDICT, /* Prediktion av utsignaler. */
+   PERF_PHASE_COUNT    /* Antalet faser. */
+};
+
+/**************************************************************************************************
+* perf_counter: Enumeration fr de hrdvarurknare som lses.
+**************************************************************************************************/
+enum perf_counter
+{
+   PERF_COUNTER_CYCLES,        /* Antalet klockcykler. */
+   PERF_COUNTER_INSTRUCTIONS,  /* Antalet exekverade instruktioner. */
+   PERF_COUNTER_LLC_MISSES,    /* Antalet cachemissar i sista cachenivn. */
+   PERF_COUNTER_BRANCH_MISSES, /* Antalet felpredikterade hopp. */
+   PERF_COUNTER_COUNT          /* Antalet rknare. */
+};
+
+/**************************************************************************************************
+* perf_sample: Avlst vrde fr en hrdvarurknare tillsammans med den tid rknaren har varit
+*              aktiverad respektive faktiskt har rknat. Tiderna skiljer sig t nr rknarna
+*              multiplexeras, vilket kompenseras genom skalning av uppmtta vrden.
+**************************************************************************************************/
+struct perf_sample
+{
+   uint64_t value;        /* Rknarens vrde. */
+   uint64_t time_enabled; /* Tid som rknaren har varit aktiverad i nanosekunder. */
+   uint64_t time_running; /* Tid som rknaren faktiskt har rknat i nanosekunder. */
+   bool valid;            /* Indikerar ifall avlsningen lyckades. */
+};
+
+/**************************************************************************************************
+* perf_counters: Strukt fr ackumulering av hrdvarurknare per fas. Rknarna ppnas fr den
+*                trd som initierar strukten och inkluderar ven trdar som skapas drefter,
+*                exempelvis trdar fr parallell inlsning, nr dessa har avslutats. Rknarna
+*                ppnas som en grupp med klockcykler som ledare, s att samtliga rknare mter
+*                samma intervall ven nr hrdvaran mste multiplexera dem.
+**************************************************************************************************/
+struct perf_counters
+{
+   int fds[PERF_COUNTER_COUNT];                            /* Fildeskriptorer (-1 = saknas). */
+   struct perf_sample start[PERF_COUNTER_COUNT];           /* Avlsningar vid fasens brjan. */
+   uint64_t totals[PERF_PHASE_COUNT][PERF_COUNTER_COUNT];  /* Ackumulerade vrden per fas. */
+   struct timespec start_time;                             /* Tidpunkt vid fasens brjan. */
+   double seconds[PERF_PHASE_COUNT];                       /* Ackumulerad tidstgng per fas. */
+   size_t calls[PERF_PHASE_COUNT];                         /* Antalet mtningar per fas. */
+};
+
+/* Externa funktioner: */
+void perf_counters_new(struct perf_counters* self);
+void perf_counters_delete(struct perf_counters* self);
+bool perf_counters_available(const struct perf_counters* self);
+void perf_counters_begin(struct perf_counters* self,
+                         const enum perf_phase phase);
+void perf_counters_end(struct perf_counters* self,
+                       const enum perf_phase phase);
+void perf_counters_print(const struct perf_counters* self,
+                         FILE* ostream);
+double perf_counters_elapsed(const struct timespec* start);
+
+#endif /* PERF_COUNTERS_H_ */
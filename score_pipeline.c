@@ -0,0 +1,459 @@
+/**************************************************************************************************
+* score_pipeline.c: Innehller funktionsdefinitioner fr strmmande batchprediktion frn fil
+*                   till fil.
+**************************************************************************************************/
+#include "score_pipeline.h"
+
+/* Makrodefinitioner: */
+#define SCORE_PIPELINE_BLOCK_SIZE (1024 * 1024) /* Blockstorlek vid lsning av infilen. */
+#define SCORE_PIPELINE_BATCH_SIZE 65536         /* Antalet vrden per batch vid prediktion. */
+#define SCORE_PIPELINE_QUEUE_CAPACITY 4         /* Antalet block per ringbuffert. */
+#define SCORE_PIPELINE_NUMBER_SIZE 32           /* Maximal lngd p ett formaterat tal. */
+
+/**************************************************************************************************
+* score_pipeline: Intern strukt som delas mellan pipelinens trdar. Lsningen sker via en
+*                 dekomprimerare, som skriver infilens innehll till ringbufferten raw. Tolkade
+*                 insignaler skrivs i batcher till ringbufferten inputs, medan predikterade
+*                 utsignaler skrivs i batcher till ringbufferten outputs. Ett steg som avbryts
+*                 stnger sin inkommande ringbuffert, vilket i sin tur avbryter fregende steg.
+**************************************************************************************************/
+struct score_pipeline
+{
+   double weight;                     /* Modellens lutning. */
+   double bias;                       /* Modellens vilovrde. */
+   enum score_pipeline_format format; /* Filformat fr in- och utfilen. */
+   FILE* ostream;                     /* Filstrm som prediktioner skrivs till. */
+   struct decompressor reader;        /* Lsningssteget. */
+   struct block_queue raw;            /* Ringbuffert fr infilens innehll. */
+   struct block_queue inputs;         /* Ringbuffert fr tolkade insignaler. */
+   struct block_queue outputs;        /* Ringbuffert fr predikterade utsignaler. */
+   double* batch;                     /* Aktuell batch i tolkningssteget (null = avbruten). */
+   size_t count;                      /* Antalet insignaler i aktuell batch. */
+   size_t rows;                       /* Antalet skrivna prediktioner. */
+   size_t skipped;                    /* Antalet rader som saknade ett tal. */
+   int parse_error;                   /* Indikerar ifall tolkningen misslyckades. */
+   int write_error;                   /* Indikerar ifall skrivningen misslyckades. */
+};
+
+// Statiska funktioner:
+static void* score_pipeline_parse(void* arg);
+static void* score_pipeline_predict(void* arg);
+static void* score_pipeline_format(void* arg);
+static bool score_pipeline_emit(struct score_pipeline* self,
+                                const double value);
+static bool score_pipeline_parse_line(void* context,
+                                      const char* begin,
+                                      const char* end);
+static bool score_pipeline_flush(struct score_pipeline* self,
+                                 const char* data,
+                                 const size_t size);
+
+/**************************************************************************************************
+* score_pipeline_run: Predikterar samtliga insignaler i angiven infil med angiven lutning och
+*                     angivet vilovrde och skriver prediktionerna till angiven utfil i samma
+*                     ordning och format. Lsning, tolkning, prediktion och formatering sker i
+*                     var sin trd. Vid textformat tolkas det frsta talet p varje rad, s att
+*                     ven trningsfiler kan anvndas som infil, medan rader som saknar ett tal,
+*                     inklusive tomma rader, ger utsignalen nan s att utfilen frblir radvis
+*                     synkroniserad med infilen. Komprimering identifieras endast vid textformat, eftersom
+*                     binra flyttal kan rka brja med samma byte som en komprimerad fil.
+*                     Returnerar 0 vid lyckad prediktion, annars 1, dr utfilen d kan vara
+*                     ofullstndig.
+*
+*                     - weight     : Modellens lutning.
+*                     - bias       : Modellens vilovrde.
+*                     - input_path : Filskvg till infilen.
+*                     - output_path: Filskvg till utfilen.
+*                     - format     : Filformat fr in- och utfilen.
+*                     - stats      : Pekare till strukt dr resultatet lagras (null = ignoreras).
+**************************************************************************************************/
+int score_pipeline_run(const double weight,
+                       const double bias,
+                       const char* input_path,
+                       const char* output_path,
+                       const enum score_pipeline_format format,
+                       struct score_pipeline_stats* stats)
+{
+   struct score_pipeline self = { .weight = weight, .bias = bias, .format = format };
+   struct block_queue* queues[3] = { &self.raw, &self.inputs, &self.outputs };
+   void* (*stages[3])(void*) = { &score_pipeline_parse, &score_pipeline_predict, &score_pipeline_format };
+   pthread_t threads[3];
+   bool started[3] = { false };
+   size_t num_queues = 0;
+   struct timespec start;
+   FILE* istream = fopen(input_path, "rb");
+   int error = 0;
+
+   if (!istream)
+   {
+      fprintf(stderr, "Could not read file at path %s!\n\n", input_path);
+      return 1;
+   }
+
+   const enum decompressor_format compression = format == SCORE_PIPELINE_FORMAT_TEXT ?
+      decompressor_detect(istream) : DECOMPRESSOR_FORMAT_NONE;
+
+   if (!decompressor_supported(compression))
+   {
+      fprintf(stderr, "Could not read %s-compressed file at path %s, support not compiled in!\n\n",
+              decompressor_format_name(compression), input_path);
+      fclose(istream);
+      return 1;
+   }
+
+   if (!(self.ostream = fopen(output_path, "wb")))
+   {
+      fprintf(stderr, "Could not open file at path %s for writing!\n\n", output_path);
+      fclose(istream);
+      return 1;
+   }
+
+   while (num_queues < 3)
+   {
+      const size_t block_size = num_queues ? sizeof(double) * SCORE_PIPELINE_BATCH_SIZE : SCORE_PIPELINE_BLOCK_SIZE;
+      if (block_queue_new(queues[num_queues], block_size, SCORE_PIPELINE_QUEUE_CAPACITY,
+                          MEM_SUBSYSTEM_SCORING)) break;
+      num_queues++;
+   }
+
+   if (num_queues < 3)
+   {
+      fprintf(stderr, "Could not allocate memory for scoring file at path %s!\n\n", input_path);
+
+      for (size_t i = 0; i < num_queues; ++i)
+      {
+         block_queue_delete(queues[i]);
+      }
+
+      fclose(istream);
+      fclose(self.ostream);
+      return 1;
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   decompressor_start(&self.reader, istream, compression, &self.raw);
+
+   for (size_t i = 0; i < 3; ++i)
+   {
+      started[i] = !pthread_create(&threads[i], 0, stages[i], &self);
+
+      if (!started[i])
+      {
+         for (size_t j = 0; j < 3; ++j)
+         {
+            block_queue_close(queues[j]);
+         }
+
+         error = 1;
+         break;
+      }
+   }
+
+   for (size_t i = 0; i < 3; ++i)
+   {
+      if (started[i]) pthread_join(threads[i], 0);
+   }
+
+   if (decompressor_join(&self.reader))
+   {
+      fprintf(stderr, "Could not read file at path %s!\n\n", input_path);
+      error = 1;
+   }
+
+   if (self.parse_error)
+   {
+      fprintf(stderr, "Could not parse file at path %s, binary input is truncated!\n\n", input_path);
+      error = 1;
+   }
+
+   if (fclose(self.ostream) || self.write_error)
+   {
+      fprintf(stderr, "Could not write file at path %s!\n\n", output_path);
+      error = 1;
+   }
+
+   if (stats)
+   {
+      stats->rows = self.rows;
+      stats->skipped = self.skipped;
+      stats->seconds = perf_counters_elapsed(&start);
+      stats->rows_per_second = stats->seconds > 0 ? (double)self.rows / stats->seconds : 0;
+   }
+
+   for (size_t i = 0; i < 3; ++i)
+   {
+      block_queue_delete(queues[i]);
+   }
+
+   fclose(istream);
+   return error;
+}
+
+/**************************************************************************************************
+* score_pipeline_parse: Trdfunktion fr tolkningssteget, som lser infilens innehll blockvis
+*                       och skriver tolkade insignaler i batcher till nsta steg. Vid textformat
+*                       stts rader som strcker sig ver flera block samman via en radlsare,
+*                       dr tecken utver blockstorleken ignoreras. Vid binrformat sparas eventuella
+*                       byte av ett ofullstndigt flyttal i slutet av ett block till nsta block.
+*                       Returnerar alltid null.
+*
+*                       - arg: Pekare till pipelinen (struct score_pipeline).
+**************************************************************************************************/
+static void* score_pipeline_parse(void* arg)
+{
+   struct score_pipeline* self = (struct score_pipeline*)arg;
+   struct line_reader reader = { .line = 0, .capacity = 0, .carry = 0, .owner = MEM_SUBSYSTEM_SCORING };
+   char pending[sizeof(double)];
+   size_t carry = 0;
+   bool running = (self->batch = (double*)block_queue_acquire(&self->inputs)) != 0;
+
+   if (running && self->format == SCORE_PIPELINE_FORMAT_TEXT)
+   {
+      running = !line_reader_new(&reader, SCORE_PIPELINE_BLOCK_SIZE, MEM_SUBSYSTEM_SCORING);
+   }
+
+   const char* block = 0;
+   size_t size = 0;
+
+   while (running && (block = block_queue_front(&self->raw, &size)))
+   {
+      size_t consumed = 0;
+
+      if (self->format == SCORE_PIPELINE_FORMAT_BINARY)
+      {
+         if (carry)
+         {
+            consumed = sizeof(double) - carry < size ? sizeof(double) - carry : size;
+            memcpy(pending + carry, block, consumed);
+            carry += consumed;
+
+            if (carry == sizeof(double))
+            {
+               double value;
+               memcpy(&value, pending, sizeof(double));
+               running = score_pipeline_emit(self, value);
+               carry = 0;
+            }
+         }
+
+         while (running && size - consumed >= sizeof(double))
+         {
+            const size_t available = (size - consumed) / sizeof(double);
+            const size_t free_slots = SCORE_PIPELINE_BATCH_SIZE - self->count;
+            const size_t copied = available < free_slots ? available : free_slots;
+            memcpy(self->batch + self->count, block + consumed, sizeof(double) * copied);
+            consumed += sizeof(double) * copied;
+            self->count += copied;
+
+            if (self->count == SCORE_PIPELINE_BATCH_SIZE)
+            {
+               block_queue_commit(&self->inputs, sizeof(double) * self->count);
+               self->count = 0;
+               running = (self->batch = (double*)block_queue_acquire(&self->inputs)) != 0;
+            }
+         }
+
+         if (running && consumed < size)
+         {
+            carry = size - consumed;
+            memcpy(pending, block + consumed, carry);
+         }
+      }
+      else
+      {
+         running = line_reader_feed(&reader, block, size, score_pipeline_parse_line, self);
+      }
+
+      block_queue_release(&self->raw);
+   }
+
+   if (running)
+   {
+      if (self->format == SCORE_PIPELINE_FORMAT_TEXT)
+      {
+         running = line_reader_finish(&reader, score_pipeline_parse_line, self);
+      }
+      else if (carry)
+      {
+         self->parse_error = 1;
+      }
+   }
+
+   if (self->batch && self->count) block_queue_commit(&self->inputs, sizeof(double) * self->count);
+   if (!running) block_queue_close(&self->raw);
+   block_queue_close(&self->inputs);
+   line_reader_delete(&reader);
+   return 0;
+}
+
+/**************************************************************************************************
+* score_pipeline_predict: Trdfunktion fr prediktionssteget, som predikterar samtliga
+*                         insignaler i respektive batch och skriver prediktionerna till nsta
+*                         steg. Prediktionen sker i en enkel loop utan beroenden mellan
+*                         iterationerna, vilket gr att kompilatorn kan vektorisera den.
+*                         Returnerar alltid null.
+*
+*                         - arg: Pekare till pipelinen (struct score_pipeline).
+**************************************************************************************************/
+static void* score_pipeline_predict(void* arg)
+{
+   struct score_pipeline* self = (struct score_pipeline*)arg;
+   const double weight = self->weight;
+   const double bias = self->bias;
+   const char* block = 0;
+   size_t size = 0;
+
+   while ((block = block_queue_front(&self->inputs, &size)))
+   {
+      const double* restrict input = (const double*)block;
+      double* restrict output = (double*)block_queue_acquire(&self->outputs);
+      const size_t count = size / sizeof(double);
+
+      if (!output)
+      {
+         block_queue_close(&self->inputs);
+         break;
+      }
+
+      for (size_t i = 0; i < count; ++i)
+      {
+         output[i] = weight * input[i] + bias;
+      }
+
+      block_queue_commit(&self->outputs, size);
+      block_queue_release(&self->inputs);
+   }
+
+   block_queue_close(&self->outputs);
+   return 0;
+}
+
+/**************************************************************************************************
+* score_pipeline_format: Trdfunktion fr formateringssteget, som skriver prediktionerna till
+*                        utfilen. Vid textformat formateras prediktionerna till en textbuffert
+*                        med ett tal per rad och full precision, dr saknade vrden skrivs som
+*                        nan, och bufferten skrivs till filen nr den r full. Vid binrformat skrivs respektive batch direkt till filen.
+*                        Returnerar alltid null.
+*
+*                        - arg: Pekare till pipelinen (struct score_pipeline).
+**************************************************************************************************/
+static void* score_pipeline_format(void* arg)
+{
+   struct score_pipeline* self = (struct score_pipeline*)arg;
+   char* text = self->format == SCORE_PIPELINE_FORMAT_TEXT ?
+      (char*)MEM_MALLOC(MEM_SUBSYSTEM_SCORING, SCORE_PIPELINE_BLOCK_SIZE) : 0;
+   size_t length = 0;
+   const char* block = 0;
+   size_t size = 0;
+
+   if (self->format == SCORE_PIPELINE_FORMAT_TEXT && !text)
+   {
+      self->write_error = 1;
+      block_queue_close(&self->outputs);
+   }
+
+   while (!self->write_error && (block = block_queue_front(&self->outputs, &size)))
+   {
+      const double* output = (const double*)block;
+      const size_t count = size / sizeof(double);
+
+      if (self->format == SCORE_PIPELINE_FORMAT_BINARY)
+      {
+         self->write_error = !score_pipeline_flush(self, block, size);
+      }
+      else
+      {
+         for (size_t i = 0; i < count && !self->write_error; ++i)
+         {
+            if (SCORE_PIPELINE_BLOCK_SIZE - length < SCORE_PIPELINE_NUMBER_SIZE)
+            {
+               self->write_error = !score_pipeline_flush(self, text, length);
+               length = 0;
+            }
+
+            if (isnan(output[i]))
+            {
+               memcpy(text + length, "nan\n", 4);
+               length += 4;
+            }
+            else
+            {
+               length += (size_t)snprintf(text + length, SCORE_PIPELINE_NUMBER_SIZE, "%.17g\n", output[i]);
+            }
+         }
+      }
+
+      if (!self->write_error) self->rows += count;
+      block_queue_release(&self->outputs);
+      if (self->write_error) block_queue_close(&self->outputs);
+   }
+
+   if (!self->write_error && length)
+   {
+      self->write_error = !score_pipeline_flush(self, text, length);
+   }
+
+   MEM_FREE(MEM_SUBSYSTEM_SCORING, text);
+   return 0;
+}
+
+/**************************************************************************************************
+* score_pipeline_emit: Lgger till en tolkad insignal i aktuell batch. Nr batchen r full
+*                      skickas den vidare till prediktionssteget och en ny batch hmtas.
+*                      Returnerar false ifall pipelinen har avbrutits, annars true.
+*
+*                      - self : Pekare till pipelinen.
+*                      - value: Insignalen som skall lggas till.
+**************************************************************************************************/
+static bool score_pipeline_emit(struct score_pipeline* self,
+                                const double value)
+{
+   self->batch[self->count++] = value;
+
+   if (self->count == SCORE_PIPELINE_BATCH_SIZE)
+   {
+      block_queue_commit(&self->inputs, sizeof(double) * self->count);
+      self->count = 0;
+      self->batch = (double*)block_queue_acquire(&self->inputs);
+   }
+
+   return self->batch != 0;
+}
+
+/**************************************************************************************************
+* score_pipeline_parse_line: Radhanterare som extraherar det frsta talet ur angiven textrad via
+*                            line_parse_numbers och lgger till det i aktuell batch. Fr rader
+*                            som saknar ett tal lggs i stllet nan till och raden rknas som
+*                            verhoppad, s att utfilen behller en rad per inrad. Returnerar
+*                            false ifall pipelinen har avbrutits, annars true.
+*
+*                            - context: Pekare till pipelinen (struct score_pipeline).
+*                            - begin  : Pekare till radens frsta tecken.
+*                            - end    : Pekare direkt efter radens sista tecken.
+**************************************************************************************************/
+static bool score_pipeline_parse_line(void* context,
+                                      const char* begin,
+                                      const char* end)
+{
+   struct score_pipeline* self = (struct score_pipeline*)context;
+   double value = NAN;
+
+   if (!line_parse_numbers(begin, end, &value, 1)) self->skipped++;
+
+   return score_pipeline_emit(self, value);
+}
+
+/**************************************************************************************************
+* score_pipeline_flush: Skriver angivet antal byte till utfilen. Returnerar true vid lyckad
+*                       skrivning, annars false.
+*
+*                       - self: Pekare till pipelinen.
+*                       - data: Pekare till datan som skall skrivas.
+*                       - size: Antalet byte som skall skrivas.
+**************************************************************************************************/
+static bool score_pipeline_flush(struct score_pipeline* self,
+                                 const char* data,
+                                 const size_t size)
+{
+   return fwrite(data, 1, size, self->ostream) == size;
+}
@@ -0,0 +1,56 @@
+/**************************************************************************************************
+* score_pipeline.h: Implementering av strmmande batchprediktion frn fil till fil. Insignaler
+*                   lses frn en textfil (ett tal per rad) eller en binrfil (flyttal i maskinens
+*                   format) och passerar stegen lsning, tolkning, prediktion samt formatering,
+*                   dr varje steg krs i en egen trd. Stegen r sammankopplade via begrnsade
+*                   ringbuffertar, s att minnestgngen r konstant oavsett filens storlek och
+*                   samtliga steg arbetar parallellt. Textfiler komprimerade med gzip eller zstd
+*                   kan lsas direkt, frutsatt att motsvarande std har kompilerats in.
+**************************************************************************************************/
+#ifndef SCORE_PIPELINE_H_
+#define SCORE_PIPELINE_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "block_queue.h"
+#include "decompressor.h"
+#include "perf_counters.h"
+#include "train_buffer.h"
+#include "mem_stats.h"
+
+/**************************************************************************************************
+* score_pipeline_format: Enumeration fr filformat vid batchprediktion. Utfilen skrivs i samma
+*                        format som infilen.
+**************************************************************************************************/
+enum score_pipeline_format
+{
+   SCORE_PIPELINE_FORMAT_TEXT,  /* Textfil med ett tal per rad. */
+   SCORE_PIPELINE_FORMAT_BINARY /* Binrfil med flyttal av typen double i maskinens format. */
+};
+
+/**************************************************************************************************
+* score_pipeline_stats: Resultat frn en batchprediktion.
+**************************************************************************************************/
+struct score_pipeline_stats
+{
+   size_t rows;            /* Antalet predikterade rader. */
+   size_t skipped;         /* Antalet rader som saknade ett tal (utsignal nan). */
+   double seconds;         /* Tidstgng i sekunder. */
+   double rows_per_second; /* Genomstrmning i antalet rader per sekund. */
+};
+
+/* Externa funktioner: */
+int score_pipeline_run(const double weight,
+                       const double bias,
+                       const char* input_path,
+                       const char* output_path,
+                       const enum score_pipeline_format format,
+                       struct score_pipeline_stats* stats);
+
+#endif /* SCORE_PIPELINE_H_ */
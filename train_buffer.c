@@ -0,0 +1,294 @@
+/**************************************************************************************************
+* train_buffer.c: Innehller funktionsdefinitioner fr tolkning av trningsdata i textformat
+*                 via strukten train_buffer, uppdelning av textblock i rader via strukten
+*                 line_reader samt tolkning av tal ur textrader.
+**************************************************************************************************/
+#include "train_buffer.h"
+
+// Statiska funktioner:
+static int train_buffer_reserve(struct double_vector* vector,
+                                const size_t capacity);
+static bool char_is_digit(const char c);
+
+/**************************************************************************************************
+* train_buffer_new: Initierar angiven buffert.
+*
+*                   - self: Pekare till bufferten.
+**************************************************************************************************/
+void train_buffer_new(struct train_buffer* self)
+{
+   double_vector_new(&self->in);
+   double_vector_new(&self->out);
+   self->size = 0;
+   return;
+}
+
+/**************************************************************************************************
+* train_buffer_delete: Tmmer innehllet i angiven buffert.
+*
+*                      - self: Pekare till bufferten.
+**************************************************************************************************/
+void train_buffer_delete(struct train_buffer* self)
+{
+   MEM_FREE(MEM_SUBSYSTEM_LOADER, self->in.data);
+   MEM_FREE(MEM_SUBSYSTEM_LOADER, self->out.data);
+   double_vector_new(&self->in);
+   double_vector_new(&self->out);
+   self->size = 0;
+   return;
+}
+
+/**************************************************************************************************
+* train_buffer_push: Lgger till en trningsuppsttning lngst bak i angiven buffert. Ifall
+*                    bufferten r full dubbleras dess kapacitet, vilket gr att antalet
+*                    omallokeringar vxer logaritmiskt med mngden trningsdata. Kapaciteten
+*                    utgrs av den minsta av vektorernas storlekar, s att en misslyckad
+*                    omallokering av den ena vektorn aldrig medfr skrivning utanfr den andra.
+*
+*                    - self  : Pekare till bufferten.
+*                    - input : Trningsuppsttningens insignal.
+*                    - output: Trningsuppsttningens utsignal.
+**************************************************************************************************/
+int train_buffer_push(struct train_buffer* self,
+                      const double input,
+                      const double output)
+{
+   const size_t capacity = self->in.size < self->out.size ? self->in.size : self->out.size;
+
+   if (self->size == capacity)
+   {
+      const size_t new_capacity = capacity ? capacity * 2 : 1024;
+      if (train_buffer_reserve(&self->in, new_capacity)) return 1;
+      if (train_buffer_reserve(&self->out, new_capacity)) return 1;
+   }
+
+   self->in.data[self->size] = input;
+   self->out.data[self->size] = output;
+   self->size++;
+   return 0;
+}
+
+/**************************************************************************************************
+* train_buffer_parse_line: Extraherar flyttal ur angiven textrad via line_parse_numbers. Ifall
+*                          exakt tv flyttal lyckas extraheras s lagras dessa som en
+*                          trningsuppsttning i bufferten.
+*
+*                          - self : Pekare till bufferten.
+*                          - begin: Pekare till radens frsta tecken.
+*                          - end  : Pekare direkt efter radens sista tecken.
+**************************************************************************************************/
+bool train_buffer_parse_line(struct train_buffer* self,
+                             const char* begin,
+                             const char* end)
+{
+   double numbers[2] = { 0 };
+   if (line_parse_numbers(begin, end, numbers, 2) != 2) return false;
+   return !train_buffer_push(self, numbers[0], numbers[1]);
+}
+
+/**************************************************************************************************
+* train_buffer_parse: Tolkar samtliga kompletta rader (avslutade med nyradstecken) i angivet
+*                     textstycke och lagrar extraherade trningsuppsttningar i bufferten.
+*                     Endast rader som brjar fre angiven grns tolkas, vilket gr att ett
+*                     textstycke kan delas upp mellan flera buffertar utan att rader tolkas tv
+*                     gnger. Antalet frbrukade tecken returneras, dr eventuell ofullstndig
+*                     rad i slutet av textstycket lmnas kvar till nsta anrop.
+*
+*                     - self : Pekare till bufferten.
+*                     - data : Pekare till textstycket.
+*                     - size : Textstyckets storlek i antalet tecken.
+*                     - limit: Grns fr radernas startposition rknat frn textstyckets brjan.
+**************************************************************************************************/
+size_t train_buffer_parse(struct train_buffer* self,
+                          const char* data,
+                          const size_t size,
+                          const size_t limit)
+{
+   const char* line = data;
+   const char* const last = data + size;
+
+   while (line < last && (size_t)(line - data) < limit)
+   {
+      const char* newline = (const char*)memchr(line, '\n', (size_t)(last - line));
+      if (!newline) break;
+      train_buffer_parse_line(self, line, newline);
+      line = newline + 1;
+   }
+
+   return (size_t)(line - data);
+}
+
+/**************************************************************************************************
+* line_reader_new: Initierar angiven radlsare med en radbuffert av angiven kapacitet, vilken
+*                  br motsvara blockstorleken. Returnerar 0 vid lyckad initiering, annars 1.
+*
+*                  - self    : Pekare till radlsaren.
+*                  - capacity: Radbuffertens kapacitet i antalet tecken.
+*                  - owner   : Delsystemet som radbuffertens minne redovisas fr.
+**************************************************************************************************/
+int line_reader_new(struct line_reader* self,
+                    const size_t capacity,
+                    const enum mem_subsystem owner)
+{
+   self->line = (char*)MEM_MALLOC(owner, capacity);
+   self->capacity = self->line ? capacity : 0;
+   self->carry = 0;
+   self->owner = owner;
+   return self->line == 0;
+}
+
+/**************************************************************************************************
+* line_reader_delete: Frigr radbufferten fr angiven radlsare.
+*
+*                     - self: Pekare till radlsaren.
+**************************************************************************************************/
+void line_reader_delete(struct line_reader* self)
+{
+   MEM_FREE(self->owner, self->line);
+   self->line = 0;
+   self->capacity = 0;
+   self->carry = 0;
+   return;
+}
+
+/**************************************************************************************************
+* line_reader_feed: Delar upp angivet textblock i rader och anropar angiven hanterare fr varje
+*                   komplett rad. En sparad ofullstndig rad frn fregende block stts frst
+*                   samman med brjan av blocket, medan en ofullstndig rad i slutet av blocket
+*                   sparas till nsta anrop. Returnerar false ifall hanteraren avbrt lsningen,
+*                   annars true.
+*
+*                   - self   : Pekare till radlsaren.
+*                   - data   : Pekare till textblocket.
+*                   - size   : Textblockets storlek i antalet tecken.
+*                   - handler: Funktion som anropas fr varje komplett rad.
+*                   - context: Kontext som skickas vidare till hanteraren.
+**************************************************************************************************/
+bool line_reader_feed(struct line_reader* self,
+                      const char* data,
+                      const size_t size,
+                      line_handler handler,
+                      void* context)
+{
+   const char* line = data;
+   const char* const last = data + size;
+
+   if (self->carry)
+   {
+      const char* newline = (const char*)memchr(data, '\n', size);
+      const size_t length = newline ? (size_t)(newline - data) : size;
+      const size_t copied = length < self->capacity - self->carry ? length : self->capacity - self->carry;
+      memcpy(self->line + self->carry, data, copied);
+      self->carry += copied;
+      if (!newline) return true;
+
+      const size_t carry = self->carry;
+      self->carry = 0;
+      if (!handler(context, self->line, self->line + carry)) return false;
+      line = newline + 1;
+   }
+
+   while (line < last)
+   {
+      const char* newline = (const char*)memchr(line, '\n', (size_t)(last - line));
+      if (!newline) break;
+      if (!handler(context, line, newline)) return false;
+      line = newline + 1;
+   }
+
+   self->carry = (size_t)(last - line) < self->capacity ? (size_t)(last - line) : self->capacity;
+   memcpy(self->line, line, self->carry);
+   return true;
+}
+
+/**************************************************************************************************
+* line_reader_finish: Anropar angiven hanterare fr en eventuell sparad sista rad som saknar
+*                     avslutande nyradstecken. Returnerar false ifall hanteraren avbrt
+*                     lsningen, annars true.
+*
+*                     - self   : Pekare till radlsaren.
+*                     - handler: Funktion som anropas fr den sista raden.
+*                     - context: Kontext som skickas vidare till hanteraren.
+**************************************************************************************************/
+bool line_reader_finish(struct line_reader* self,
+                        line_handler handler,
+                        void* context)
+{
+   const size_t carry = self->carry;
+   self->carry = 0;
+   return !carry || handler(context, self->line, self->line + carry);
+}
+
+/**************************************************************************************************
+* line_parse_numbers: Extraherar tal ur angiven textrad och lagrar upp till angivet maximalt
+*                     antal tal. Tal avgrnsas av samtliga tecken som inte kan ing i ett tal,
+*                     exempelvis blanksteg och vagnretur. Bde punkt och kommatecken accepteras
+*                     som decimaltecken och tal kan anges med exponent, exempelvis 1e-3.
+*                     Respektive ord tolkas via strtod, dr ord som strtod inte kan tolka alls,
+*                     exempelvis ett ensamt minustecken, ignoreras. Antalet funna tal returneras,
+*                     vilket kan verstiga angivet maximalt antal.
+*
+*                     - begin    : Pekare till radens frsta tecken.
+*                     - end      : Pekare direkt efter radens sista tecken.
+*                     - numbers  : Pekare till array dr extraherade tal lagras.
+*                     - max_count: Maximalt antal tal som lagras.
+**************************************************************************************************/
+size_t line_parse_numbers(const char* begin,
+                          const char* end,
+                          double* numbers,
+                          const size_t max_count)
+{
+   char num_str[32] = { '\0' };
+   size_t index = 0;
+   size_t count = 0;
+
+   for (const char* i = begin; i <= end; ++i)
+   {
+      if (i < end && char_is_digit(*i) && (index || (*i != 'e' && *i != 'E')))
+      {
+         if (index < sizeof(num_str) - 1) num_str[index++] = *i == ',' ? '.' : *i;
+      }
+      else if (index)
+      {
+         char* parsed = 0;
+         num_str[index] = '\0';
+         const double value = strtod(num_str, &parsed);
+         index = 0;
+         if (parsed == num_str) continue;
+         if (count < max_count) numbers[count] = value;
+         count++;
+      }
+   }
+
+   return count;
+}
+
+/**************************************************************************************************
+* train_buffer_reserve: Omallokerar angiven vektor till angiven kapacitet, dr minnet redovisas
+*                       fr inlsningen. Vid misslyckad omallokering lmnas vektorn orrd.
+*                       Returnerar 0 vid lyckad omallokering, annars 1.
+*
+*                       - vector  : Pekare till vektorn som skall omallokeras.
+*                       - capacity: Vektorns nya kapacitet.
+**************************************************************************************************/
+static int train_buffer_reserve(struct double_vector* vector,
+                                const size_t capacity)
+{
+   double* copy = (double*)MEM_REALLOC(MEM_SUBSYSTEM_LOADER, vector->data, sizeof(double) * capacity);
+   if (!copy) return 1;
+   vector->data = copy;
+   vector->size = capacity;
+   return 0;
+}
+
+/**************************************************************************************************
+* char_is_digit: Indikerar ifall givet tecken utgr en siffra eller ett relaterat tecken, ssom
+*                ett minustecken, en punkt eller en exponent. Eftersom flyttal ibland matas in
+*                bde med punkt samt kommatecken s utgr bda giltiga tecken.
+*
+*                - c: Det tecken som skall kontrolleras.
+**************************************************************************************************/
+static bool char_is_digit(const char c)
+{
+   return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == ',' || c == 'e' || c == 'E';
+}
@@ -0,0 +1,87 @@
+/**************************************************************************************************
+* train_buffer.h: Implementering av buffertar fr tolkning av trningsdata i textformat via
+*                 strukten train_buffer samt motsvarande externa funktioner. Bufferten anvnds
+*                 exempelvis fr att lta flera trdar tolka var sitt stycke av en textfil, dr
+*                 resultatet sedan sls samman i en regressionsmodell. Hr finns ven
+*                 strukten line_reader, som stter samman rader som strcker sig ver flera
+*                 block vid strmmande lsning, samt tolkning av tal ur en textrad, vilka
+*                 anvnds bde vid inlsning av trningsdata och vid strmmande prediktion.
+**************************************************************************************************/
+#ifndef TRAIN_BUFFER_H_
+#define TRAIN_BUFFER_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "double_vector.h"
+#include "mem_stats.h"
+
+/**************************************************************************************************
+* train_buffer: Buffert fr lagring av tolkade trningsuppsttningar. Vektorerna allokeras i
+*               strre steg n en uppsttning t gngen, s vektorernas storlek utgr buffertens
+*               kapacitet medan antalet lagrade uppsttningar lagras separat. Vektorernas minne
+*               hanteras av bufferten sjlv och redovisas fr inlsningen, inte fr vektorerna.
+**************************************************************************************************/
+struct train_buffer
+{
+   struct double_vector in;  /* Insignaler fr tolkade trningsuppsttningar. */
+   struct double_vector out; /* Utsignaler fr tolkade trningsuppsttningar. */
+   size_t size;              /* Antalet lagrade trningsuppsttningar. */
+};
+
+/**************************************************************************************************
+* line_handler: Funktionspekare fr hantering av en komplett textrad utan nyradstecken, dr
+*               angiven kontext skickas vidare ofrndrad. Returnerar false fr att avbryta
+*               lsningen, annars true.
+**************************************************************************************************/
+typedef bool (*line_handler)(void* context,
+                             const char* begin,
+                             const char* end);
+
+/**************************************************************************************************
+* line_reader: Strukt fr uppdelning av strmmande textblock i rader. Kompletta rader i ett block
+*              hanteras direkt i blocket, medan en ofullstndig rad i slutet av ett block sparas
+*              i en radbuffert och stts samman med brjan av nsta block. Tecken utver
+*              radbuffertens kapacitet ignoreras.
+**************************************************************************************************/
+struct line_reader
+{
+   char* line;               /* Radbuffert fr rader som strcker sig ver flera block. */
+   size_t capacity;          /* Radbuffertens kapacitet i antalet tecken. */
+   size_t carry;             /* Antalet sparade tecken i radbufferten. */
+   enum mem_subsystem owner; /* Delsystemet som radbuffertens minne redovisas fr. */
+};
+
+/* Externa funktioner: */
+void train_buffer_new(struct train_buffer* self);
+void train_buffer_delete(struct train_buffer* self);
+int train_buffer_push(struct train_buffer* self,
+                      const double input,
+                      const double output);
+bool train_buffer_parse_line(struct train_buffer* self,
+                             const char* begin,
+                             const char* end);
+size_t train_buffer_parse(struct train_buffer* self,
+                          const char* data,
+                          const size_t size,
+                          const size_t limit);
+int line_reader_new(struct line_reader* self,
+                    const size_t capacity,
+                    const enum mem_subsystem owner);
+void line_reader_delete(struct line_reader* self);
+bool line_reader_feed(struct line_reader* self,
+                      const char* data,
+                      const size_t size,
+                      line_handler handler,
+                      void* context);
+bool line_reader_finish(struct line_reader* self,
+                        line_handler handler,
+                        void* context);
+size_t line_parse_numbers(const char* begin,
+                          const char* end,
+                          double* numbers,
+                          const size_t max_count);
+
+#endif /* TRAIN_BUFFER_H_ */
@@ -23,7 +23,7 @@ void uint_vector_new(struct uint_vector* self)
 **************************************************************************************************/
 void uint_vector_delete(struct uint_vector* self)
 {
-   free(self->data);
+   MEM_FREE(MEM_SUBSYSTEM_UINT_VECTOR, self->data);
    self->data = 0;
    self->size = 0;
    return;
@@ -36,7 +36,7 @@ void uint_vector_delete(struct uint_vector* self)
 **************************************************************************************************/
 struct uint_vector* uint_vector_ptr_new(const size_t size)
 {
-   struct uint_vector* self = (struct uint_vector*)malloc(sizeof(struct uint_vector));
+   struct uint_vector* self = (struct uint_vector*)MEM_MALLOC(MEM_SUBSYSTEM_UINT_VECTOR, sizeof(struct uint_vector));
    if (!self) return 0;
    self->data = 0;
    self->size = 0;
@@ -54,7 +54,7 @@ struct uint_vector* uint_vector_ptr_new(const size_t size)
 void uint_vector_ptr_delete(struct uint_vector** self)
 {
    uint_vector_delete(*self);
-   free(*self);
+   MEM_FREE(MEM_SUBSYSTEM_UINT_VECTOR, *self);
    *self = 0;
    return;
 }
@@ -68,7 +68,7 @@ void uint_vector_ptr_delete(struct uint_vector** self)
 int uint_vector_resize(struct uint_vector* self, 
                        const size_t new_size)
 {
-   size_t* copy = (size_t*)realloc(self->data, sizeof(size_t) * new_size);
+   size_t* copy = (size_t*)MEM_REALLOC(MEM_SUBSYSTEM_UINT_VECTOR, self->data, sizeof(size_t) * new_size);
    if (!copy) return 1;
    self->data = copy;
    self->size = new_size;
@@ -84,7 +84,7 @@ int uint_vector_resize(struct uint_vector* self,
 int uint_vector_push(struct uint_vector* self, 
                      const size_t new_element)
 {
-   size_t* copy = (size_t*)realloc(self->data, sizeof(size_t) * (self->size + 1));
+   size_t* copy = (size_t*)MEM_REALLOC(MEM_SUBSYSTEM_UINT_VECTOR, self->data, sizeof(size_t) * (self->size + 1));
    if (!copy) return 1;
    copy[self->size++] = new_element;
    self->data = copy;
@@ -105,7 +105,7 @@ int uint_vector_pop(struct uint_vector* self)
    }
    else
    {
-      size_t* copy = (size_t*)realloc(self->data, sizeof(size_t) * (self->size - 1));
+      size_t* copy = (size_t*)MEM_REALLOC(MEM_SUBSYSTEM_UINT_VECTOR, self->data, sizeof(size_t) * (self->size - 1));
       if (!copy) return 1;
       self->data = copy;
       self->size--;
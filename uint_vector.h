@@ -8,6 +8,7 @@
 /* Inkluderingsdirektiv: */
 #include <stdio.h>
 #include <stdlib.h>
+#include "mem_stats.h"
 
 /**************************************************************************************************
 * uint_vector: Vektor innehllande ett dynamiskt flt fr lagring av osignerade heltal. Antalet 